@@ -5,10 +5,48 @@ defmodule ChatService.VectorService.Client do
 
   @default_url "http://localhost:50052"
 
+  # Binary framing understood by vector_service for /search, /batch_search,
+  # /insert and /batch_insert (see vector_service/include/binary_protocol.hpp).
+  # Vectors travel as raw little-endian float32 instead of JSON text.
+  @binary_magic 0x31425356
+  @binary_content_type ~c"application/octet-stream"
+
+  # Requests give up after this long. The same deadline is sent to
+  # vector_service as X-Request-Deadline so it stops searching once nobody
+  # is waiting for the answer.
+  @request_timeout 30_000
+
+  # JSON request bodies above this size are gzipped; vector_service
+  # decompresses them and gzips large responses when asked to.
+  @compress_threshold 64 * 1024
+
   def base_url do
     System.get_env("VECTOR_SERVICE_URL", @default_url)
   end
 
+  # When VECTOR_SERVICE_SOCKET names vector_service's Unix socket (shared
+  # through a volume in docker-compose), requests go over it instead of
+  # loopback TCP. The URL host is then ignored.
+  defp httpc_profile do
+    case System.get_env("VECTOR_SERVICE_SOCKET") do
+      nil -> :default
+      "" -> :default
+      path -> unix_socket_profile(path)
+    end
+  end
+
+  defp unix_socket_profile(path) do
+    case :inets.start(:httpc, profile: :vector_unix) do
+      {:ok, _} ->
+        :httpc.set_options([{:ipfamily, :local}, {:unix_socket, to_charlist(path)}], :vector_unix)
+
+      {:error, {:already_started, _}} ->
+        :ok
+    end
+
+    :vector_unix
+  end
+
   # Collections (Datasets)
 
   def list_collections do
@@ -49,22 +87,14 @@ defmodule ChatService.VectorService.Client do
   def insert(collection, id, values, metadata \\ %{}) do
     require Logger
 
-    # Round floats to 6 decimal places to reduce JSON size
-    # This avoids C++ JSON parser buffer limits while maintaining embedding quality
-    rounded_values = Enum.map(values, &Float.round(&1, 6))
+    Logger.debug("[VectorClient] insert: collection=#{collection}, id=#{id}, values_len=#{length(values)}")
 
-    Logger.debug("[VectorClient] insert: collection=#{collection}, id=#{id}, values_len=#{length(rounded_values)}")
-
-    body = %{
-      collection: collection,
-      vector: %{
-        id: id,
-        values: rounded_values,
-        metadata: metadata
-      }
-    }
+    frame = encode_frame(collection, [values], 0) <> encode_record(id, metadata)
 
-    post("/insert", body)
+    case post_binary("/insert", frame) do
+      {:ok, resp_body} -> {:ok, Jason.decode!(resp_body)}
+      error -> error
+    end
   end
 
   def batch_insert(collection, vectors) do
@@ -77,29 +107,12 @@ defmodule ChatService.VectorService.Client do
   end
 
   def search(collection, query, top_k \\ 10) do
-    # Round floats to 6 decimal places to reduce JSON size
-    rounded_query = Enum.map(query, &Float.round(&1, 6))
-
-    body = %{
-      collection: collection,
-      query: rounded_query,
-      top_k: top_k
-    }
-
-    case post("/search", body) do
-      {:ok, %{"results" => results, "search_time_ms" => time}} ->
-        parsed =
-          Enum.map(results, fn r ->
-            %{
-              id: r["id"],
-              score: r["score"],
-              metadata: r["metadata"] || %{}
-            }
-          end)
-        {:ok, %{results: parsed, time_ms: time}}
-
-      {:ok, response} ->
-        {:error, "Unexpected response: #{inspect(response)}"}
+    case post_binary("/search", encode_frame(collection, [query], top_k)) do
+      {:ok, resp_body} ->
+        case decode_results(resp_body) do
+          {:ok, [results], time} -> {:ok, %{results: results, time_ms: time}}
+          _ -> {:error, "Unexpected response: #{inspect(resp_body, limit: 64)}"}
+        end
 
       {:error, reason} ->
         {:error, reason}
@@ -155,12 +168,12 @@ defmodule ChatService.VectorService.Client do
   defp get(path) do
     url = base_url() <> path
 
-    case :httpc.request(:get, {to_charlist(url), []}, [{:timeout, 30_000}], []) do
-      {:ok, {{_, 200, _}, _, body}} ->
-        {:ok, Jason.decode!(to_string(body))}
+    case :httpc.request(:get, {to_charlist(url), deadline_headers()}, [{:timeout, @request_timeout}], [], httpc_profile()) do
+      {:ok, {{_, 200, _}, headers, body}} ->
+        {:ok, Jason.decode!(response_body(headers, body))}
 
-      {:ok, {{_, status, _}, _, body}} ->
-        {:error, %{status: status, body: to_string(body)}}
+      {:ok, {{_, status, _}, headers, body}} ->
+        {:error, %{status: status, body: response_body(headers, body)}}
 
       {:error, reason} ->
         {:error, reason}
@@ -173,32 +186,136 @@ defmodule ChatService.VectorService.Client do
     json_body = Jason.encode!(body)
     Logger.debug("[VectorClient] POST #{path}: body_size=#{byte_size(json_body)}, first_100=#{String.slice(json_body, 0..100)}")
 
+    {encoding_headers, json_body} = maybe_compress(json_body)
+
     case :httpc.request(
            :post,
-           {to_charlist(url), [], ~c"application/json", json_body},
-           [{:timeout, 30_000}],
-           []
+           {to_charlist(url), encoding_headers ++ deadline_headers(), ~c"application/json", json_body},
+           [{:timeout, @request_timeout}],
+           [],
+           httpc_profile()
          ) do
-      {:ok, {{_, 200, _}, _, resp_body}} ->
-        {:ok, Jason.decode!(to_string(resp_body))}
+      {:ok, {{_, 200, _}, headers, resp_body}} ->
+        {:ok, Jason.decode!(response_body(headers, resp_body))}
 
-      {:ok, {{_, status, _}, _, resp_body}} ->
-        {:error, %{status: status, body: to_string(resp_body)}}
+      {:ok, {{_, status, _}, headers, resp_body}} ->
+        {:error, %{status: status, body: response_body(headers, resp_body)}}
 
       {:error, reason} ->
         {:error, reason}
     end
   end
 
+  defp post_binary(path, frame) do
+    url = base_url() <> path
+
+    case :httpc.request(
+           :post,
+           {to_charlist(url), deadline_headers(), @binary_content_type, frame},
+           [{:timeout, @request_timeout}],
+           [{:body_format, :binary}],
+           httpc_profile()
+         ) do
+      {:ok, {{_, 200, _}, headers, resp_body}} ->
+        {:ok, response_body(headers, resp_body)}
+
+      {:ok, {{_, status, _}, headers, resp_body}} ->
+        {:error, %{status: status, body: response_body(headers, resp_body)}}
+
+      {:error, reason} ->
+        {:error, reason}
+    end
+  end
+
+  defp deadline_headers do
+    deadline = System.system_time(:millisecond) + @request_timeout
+
+    [
+      {~c"x-request-deadline", to_charlist(Integer.to_string(deadline))},
+      {~c"accept-encoding", ~c"gzip"}
+    ]
+  end
+
+  defp maybe_compress(body) when byte_size(body) > @compress_threshold do
+    {[{~c"content-encoding", ~c"gzip"}], :zlib.gzip(body)}
+  end
+
+  defp maybe_compress(body), do: {[], body}
+
+  defp response_body(headers, body) do
+    body = IO.iodata_to_binary(body)
+
+    case List.keyfind(headers, ~c"content-encoding", 0) do
+      {_, ~c"gzip"} -> :zlib.gunzip(body)
+      _ -> body
+    end
+  end
+
+  defp encode_frame(collection, [first | _] = vectors, top_k) do
+    floats = for vector <- vectors, v <- vector, into: <<>>, do: <<v::float-little-32>>
+
+    <<@binary_magic::little-32, byte_size(collection)::little-16, collection::binary,
+      length(first)::little-32, length(vectors)::little-32, top_k::little-32, floats::binary>>
+  end
+
+  defp encode_record(id, metadata) do
+    id = to_string(id || "")
+
+    entries =
+      for {k, v} <- metadata, into: <<>> do
+        key = to_string(k)
+        value = if is_binary(v), do: v, else: Jason.encode!(v)
+        <<byte_size(key)::little-16, key::binary, byte_size(value)::little-32, value::binary>>
+      end
+
+    <<byte_size(id)::little-16, id::binary, map_size(metadata)::little-16, entries::binary>>
+  end
+
+  defp decode_results(<<@binary_magic::little-32, count::little-32, time::float-little-32, rest::binary>>) do
+    {lists, rest} = decode_many(count, rest, &decode_result_list/1)
+    if rest == <<>>, do: {:ok, lists, time}, else: :error
+  end
+
+  defp decode_results(_), do: :error
+
+  defp decode_result_list(<<count::little-32, rest::binary>>) do
+    decode_many(count, rest, &decode_result/1)
+  end
+
+  defp decode_result(
+         <<score::float-little-32, id_len::little-16, id::binary-size(id_len), entries::little-16,
+           rest::binary>>
+       ) do
+    {pairs, rest} = decode_many(entries, rest, &decode_metadata_entry/1)
+    {%{id: id, score: score, metadata: Map.new(pairs)}, rest}
+  end
+
+  defp decode_metadata_entry(
+         <<key_len::little-16, key::binary-size(key_len), value_len::little-32,
+           value::binary-size(value_len), rest::binary>>
+       ) do
+    {{key, value}, rest}
+  end
+
+  defp decode_many(count, binary, fun) do
+    {items, rest} =
+      Enum.reduce(1..count//1, {[], binary}, fn _, {acc, bin} ->
+        {item, bin} = fun.(bin)
+        {[item | acc], bin}
+      end)
+
+    {Enum.reverse(items), rest}
+  end
+
   defp delete(path) do
     url = base_url() <> path
 
-    case :httpc.request(:delete, {to_charlist(url), []}, [{:timeout, 30_000}], []) do
-      {:ok, {{_, 200, _}, _, body}} ->
-        {:ok, Jason.decode!(to_string(body))}
+    case :httpc.request(:delete, {to_charlist(url), deadline_headers()}, [{:timeout, @request_timeout}], [], httpc_profile()) do
+      {:ok, {{_, 200, _}, headers, body}} ->
+        {:ok, Jason.decode!(response_body(headers, body))}
 
-      {:ok, {{_, status, _}, _, body}} ->
-        {:error, %{status: status, body: to_string(body)}}
+      {:ok, {{_, status, _}, headers, body}} ->
+        {:error, %{status: status, body: response_body(headers, body)}}
 
       {:error, reason} ->
         {:error, reason}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace vectordb {
+
+struct AdmissionConfig {
+    // Requests accepted but not yet answered, across all tenants. Past this,
+    // new requests are rejected instead of queueing behind the backlog.
+    size_t max_pending = 1024;
+
+    // Requests one tenant may have queued or executing at once. A request is
+    // charged to its tenant as soon as its collection is known: on arrival
+    // for gRPC calls and HTTP routes that name it in the path, otherwise when
+    // a worker has parsed the body. Past the limit the tenant's requests are
+    // shed instead of occupying every worker. 0 disables the limit.
+    size_t max_tenant_in_flight = 8;
+};
+
+// Tenant collections are named tenant__namespace (see make_collection_name);
+// anything else is its own tenant.
+std::string_view tenant_of(std::string_view collection);
+
+// Bounds the work the servers accept, so a burst from one tenant is shed
+// quickly rather than starving everyone queued behind it. Shared by the HTTP
+// and gRPC servers.
+class AdmissionController {
+public:
+    // Held for the lifetime of an admitted request; releases its place on
+    // destruction. An empty Ticket means the request was rejected.
+    class Ticket {
+    public:
+        Ticket() = default;
+        Ticket(Ticket&& other) noexcept;
+        Ticket& operator=(Ticket&& other) noexcept;
+        ~Ticket();
+
+        explicit operator bool() const { return owner_ != nullptr; }
+
+    private:
+        friend class AdmissionController;
+        void release();
+
+        AdmissionController* owner_ = nullptr;
+        std::string tenant_;
+    };
+
+    enum class Rejection { None, Overloaded, TenantLimit };
+
+    // Only tenants with requests in flight are tracked, so the table is
+    // bounded by max_pending however many collection names clients send;
+    // `rejected` counts from when the tenant last became busy.
+    struct TenantStats {
+        std::string tenant;
+        size_t in_flight = 0;
+        uint64_t rejected = 0;
+    };
+
+    struct Stats {
+        size_t pending = 0;
+        size_t max_pending = 0;
+        size_t max_tenant_in_flight = 0;
+        uint64_t admitted = 0;
+        uint64_t rejected_overloaded = 0;
+        uint64_t rejected_tenant = 0;
+        std::vector<TenantStats> tenants;
+    };
+
+    explicit AdmissionController(const AdmissionConfig& config = {});
+
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    // Takes a global place for a new request.
+    Ticket admit(Rejection& rejection);
+
+    // Charges an admitted request to its tenant once the collection is known.
+    // On rejection the ticket keeps its global place; drop it to release.
+    bool admit_tenant(Ticket& ticket, std::string_view collection, Rejection& rejection);
+
+    Stats stats() const;
+    const AdmissionConfig& config() const { return config_; }
+
+private:
+    struct TenantState {
+        size_t in_flight = 0;
+        uint64_t rejected = 0;
+    };
+
+    void release(const std::string& tenant);
+
+    AdmissionConfig config_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<uint64_t> admitted_{0};
+    std::atomic<uint64_t> rejected_overloaded_{0};
+    std::atomic<uint64_t> rejected_tenant_{0};
+
+    mutable std::mutex tenants_mutex_;
+    std::unordered_map<std::string, TenantState> tenants_;
+};
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include "hnsw_index.hpp"
+
+namespace vectordb {
+namespace binary {
+
+// application/octet-stream framing for /search, /batch_search, /insert and
+// /batch_insert. All integers and floats are little-endian.
+//
+// Request:
+//   u32  magic "VSB1"
+//   u16  collection length, then the collection name
+//   u32  dimension D
+//   u32  vector count C
+//   u32  top_k (ignored by the insert endpoints)
+//   f32  C * D vector components, row-major
+//   insert endpoints only, C records:
+//     u16 id length, id (empty = server generated)
+//     u16 metadata entries, each: u16 key length, key, u32 value length, value
+//
+// Search response:
+//   u32  magic "VSB1"
+//   u32  query count Q
+//   f32  search time in ms
+//   Q times: u32 result count R, then R times:
+//     f32 score, u16 id length, id, u16 metadata entries (encoded as above)
+
+constexpr uint32_t MAGIC = 0x31425356;
+constexpr const char* CONTENT_TYPE = "application/octet-stream";
+
+struct Frame {
+    std::string collection;
+    uint32_t dimension = 0;
+    uint32_t count = 0;
+    uint32_t top_k = 0;
+    std::string_view vectors;
+    std::vector<std::string> ids;
+    std::vector<std::unordered_map<std::string, std::string>> metadata;
+
+    std::vector<float> vector(size_t i) const;
+};
+
+// Collection named in a request frame's header, without decoding the rest;
+// empty if the header is malformed.
+std::string_view peek_collection(std::string_view data);
+
+// Returns an empty string on success, otherwise what is wrong with the frame.
+std::string decode_request(std::string_view data, bool with_records, Frame& frame);
+
+// Returns an empty string on success, otherwise why the results don't fit
+// the frame's length fields (ids and keys over 65535 bytes, say); `out` is
+// then incomplete and must not be sent.
+std::string encode_results(const std::vector<std::vector<HNSWResult>>& results,
+                           float time_ms, bool with_metadata, std::string& out);
+
+}
+}
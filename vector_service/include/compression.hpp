@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace vectordb {
+namespace compression {
+
+// HTTP content codings. gzip always uses zlib; zstd is only available when
+// built with HAVE_ZSTD.
+enum class Encoding : uint8_t { Identity, Gzip, Zstd };
+
+const char* name(Encoding encoding);
+
+// Parses a Content-Encoding value. Returns false for codings this build
+// cannot decode.
+bool parse_encoding(std::string_view value, Encoding& encoding);
+
+// Picks the response coding from an Accept-Encoding value: zstd over gzip,
+// honouring q=0. Identity when the client accepts neither.
+Encoding negotiate(std::string_view accept_encoding);
+
+// Incremental decoder; input may arrive split at any byte.
+class Decoder {
+public:
+    static std::unique_ptr<Decoder> create(Encoding encoding);
+    virtual ~Decoder() = default;
+
+    // Decodes from the front of `input`, advancing it past what was
+    // consumed, and writes at most `capacity` bytes to `dest`. Returns the
+    // bytes written, or -1 on corrupt input (see error()). Returns 0 only
+    // when it needs more input or the stream has ended.
+    virtual long decode(std::string_view& input, char* dest, size_t capacity) = 0;
+
+    // True once the end of the compressed stream has been decoded.
+    virtual bool finished() const = 0;
+
+    const std::string& error() const { return error_; }
+
+protected:
+    std::string error_;
+};
+
+// Incremental encoder for response bodies.
+class Encoder {
+public:
+    enum class Flush { None, Sync, Finish };
+
+    static std::unique_ptr<Encoder> create(Encoding encoding);
+    virtual ~Encoder() = default;
+
+    // Compresses `input`, appending to `out`. Sync makes everything so far
+    // decodable by the client (used per chunk of a streamed response);
+    // Finish ends the stream.
+    virtual void encode(std::string_view input, std::string& out, Flush flush) = 0;
+};
+
+// One-shot helpers.
+std::string compress(Encoding encoding, std::string_view input);
+
+}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace vectordb {
+
+// Thrown out of a search whose deadline passed or whose caller went away.
+class DeadlineExceeded : public std::runtime_error {
+public:
+    explicit DeadlineExceeded(bool cancelled)
+        : std::runtime_error(cancelled ? "Request cancelled" : "Deadline exceeded")
+        , cancelled_(cancelled) {}
+
+    // True when the caller cancelled or disconnected rather than timing out.
+    bool cancelled() const { return cancelled_; }
+
+private:
+    bool cancelled_;
+};
+
+// When a request stops being worth finishing. Searches check it between
+// queries and give up with DeadlineExceeded, so work nobody is waiting for
+// frees its thread for live requests. A default Deadline never expires.
+class Deadline {
+public:
+    using clock = std::chrono::steady_clock;
+
+    Deadline() = default;
+    explicit Deadline(clock::time_point at) : at_(at) {}
+
+    // Converts a wall-clock deadline (as sent by clients) to the steady clock.
+    static Deadline at_system_time(std::chrono::system_clock::time_point at) {
+        auto now = std::chrono::system_clock::now();
+        if (at >= now + std::chrono::hours(24 * 365)) return {};
+        return Deadline(clock::now() + std::chrono::duration_cast<clock::duration>(at - now));
+    }
+
+    // Polled alongside the time limit; returns true once the caller has gone away.
+    void set_cancel_check(std::function<bool()> check) { cancelled_ = std::move(check); }
+
+    bool is_cancelled() const { return cancelled_ && cancelled_(); }
+    bool has_time_limit() const { return at_ != clock::time_point::max(); }
+    bool timed_out() const { return has_time_limit() && clock::now() >= at_; }
+    bool expired() const { return timed_out() || is_cancelled(); }
+
+    void check() const {
+        if (timed_out()) throw DeadlineExceeded(false);
+        if (is_cancelled()) throw DeadlineExceeded(true);
+    }
+
+private:
+    clock::time_point at_ = clock::time_point::max();
+    std::function<bool()> cancelled_;
+};
+
+}
@@ -4,90 +4,179 @@
 #include <memory>
 #include <atomic>
 #include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
 #include "vector_service.grpc.pb.h"
 #include "vector_storage.hpp"
+#include "admission.hpp"
+#include "latency_histogram.hpp"
+#include "message_arena.hpp"
+#include "thread_pool.hpp"
 
 namespace vectordb {
 
-class VectorServiceImpl final : public ::vectordb::VectorService::Service {
-public:
-    explicit VectorServiceImpl(std::shared_ptr<VectorStorage> storage);
-    ~VectorServiceImpl() override = default;
+struct GRPCServerConfig {
+    // Threads running RPC handlers. gRPC's own callback threads only admit
+    // a call and hand it over, so a slow search never stalls them.
+    size_t num_workers = std::thread::hardware_concurrency();
+    // Buffer memory gRPC may hold across all calls; once it runs out, it
+    // stops reading from clients until memory is freed. 0 keeps gRPC's default.
+    size_t memory_quota_bytes = 0;
+    // Threads gRPC itself may create. 0 keeps gRPC's default.
+    int max_grpc_threads = 0;
+    size_t max_message_bytes = 100 * 1024 * 1024;
+    // Queries a StreamSearch call may have read but not yet answered; past
+    // this, the server stops reading until results have been written.
+    size_t max_stream_queries = 64;
+};
 
-    grpc::Status CreateCollection(
-        grpc::ServerContext* context,
+class VectorServiceImpl final : public ::vectordb::VectorService::CallbackService {
+public:
+    VectorServiceImpl(std::shared_ptr<VectorStorage> storage,
+                      std::shared_ptr<AdmissionController> admission,
+                      std::shared_ptr<LatencyMetrics> metrics,
+                      const GRPCServerConfig& config);
+    ~VectorServiceImpl() override;
+
+    grpc::ServerUnaryReactor* CreateCollection(
+        grpc::CallbackServerContext* context,
         const ::vectordb::CreateCollectionRequest* request,
         ::vectordb::CreateCollectionResponse* response) override;
 
-    grpc::Status DeleteCollection(
-        grpc::ServerContext* context,
+    grpc::ServerUnaryReactor* DeleteCollection(
+        grpc::CallbackServerContext* context,
         const ::vectordb::DeleteCollectionRequest* request,
         ::vectordb::DeleteCollectionResponse* response) override;
 
-    grpc::Status ListCollections(
-        grpc::ServerContext* context,
+    grpc::ServerUnaryReactor* ListCollections(
+        grpc::CallbackServerContext* context,
         const ::vectordb::ListCollectionsRequest* request,
         ::vectordb::ListCollectionsResponse* response) override;
 
-    grpc::Status Insert(
-        grpc::ServerContext* context,
+    grpc::ServerUnaryReactor* Insert(
+        grpc::CallbackServerContext* context,
         const ::vectordb::InsertRequest* request,
         ::vectordb::InsertResponse* response) override;
 
-    grpc::Status BatchInsert(
-        grpc::ServerContext* context,
+    grpc::ServerUnaryReactor* BatchInsert(
+        grpc::CallbackServerContext* context,
         const ::vectordb::BatchInsertRequest* request,
         ::vectordb::BatchInsertResponse* response) override;
 
-    grpc::Status Delete(
-        grpc::ServerContext* context,
+    grpc::ServerUnaryReactor* Delete(
+        grpc::CallbackServerContext* context,
         const ::vectordb::DeleteRequest* request,
         ::vectordb::DeleteResponse* response) override;
 
-    grpc::Status Search(
-        grpc::ServerContext* context,
+    grpc::ServerReadReactor<::vectordb::BatchInsertRequest>* StreamInsert(
+        grpc::CallbackServerContext* context,
+        ::vectordb::StreamInsertResponse* response) override;
+
+    grpc::ServerUnaryReactor* Search(
+        grpc::CallbackServerContext* context,
         const ::vectordb::SearchRequest* request,
         ::vectordb::SearchResponse* response) override;
 
-    grpc::Status BatchSearch(
-        grpc::ServerContext* context,
+    grpc::ServerUnaryReactor* BatchSearch(
+        grpc::CallbackServerContext* context,
         const ::vectordb::BatchSearchRequest* request,
         ::vectordb::BatchSearchResponse* response) override;
 
-    grpc::Status GetVector(
-        grpc::ServerContext* context,
+    grpc::ServerBidiReactor<::vectordb::StreamSearchRequest, ::vectordb::StreamSearchResponse>*
+    StreamSearch(grpc::CallbackServerContext* context) override;
+
+    grpc::ServerUnaryReactor* GetVector(
+        grpc::CallbackServerContext* context,
         const ::vectordb::GetVectorRequest* request,
         ::vectordb::GetVectorResponse* response) override;
 
-    grpc::Status Health(
-        grpc::ServerContext* context,
+    grpc::ServerUnaryReactor* Health(
+        grpc::CallbackServerContext* context,
         const ::vectordb::HealthRequest* request,
         ::vectordb::HealthResponse* response) override;
 
-    grpc::Status Stats(
-        grpc::ServerContext* context,
+    grpc::ServerUnaryReactor* Stats(
+        grpc::CallbackServerContext* context,
         const ::vectordb::StatsRequest* request,
         ::vectordb::StatsResponse* response) override;
 
+    // Lets queued handlers finish, then stops the workers.
+    void shutdown();
+
 private:
+    class InsertStream;
+    class SearchStream;
+
+    // OK when the call may proceed; `ticket` must be held until it returns.
+    grpc::Status admit(std::string_view collection, AdmissionController::Ticket& ticket);
+
+    // Admits the call, then runs `handler` on a worker and finishes the
+    // call with its status. Admitted calls are timed under `endpoint`.
+    template <typename Request, typename Response>
+    grpc::ServerUnaryReactor* dispatch(
+        grpc::CallbackServerContext* context, std::string_view endpoint, std::string_view collection,
+        grpc::Status (VectorServiceImpl::*handler)(grpc::CallbackServerContext*, const Request*, Response*),
+        const Request* request, Response* response);
+
+    grpc::Status create_collection(grpc::CallbackServerContext* context,
+        const ::vectordb::CreateCollectionRequest* request, ::vectordb::CreateCollectionResponse* response);
+    grpc::Status delete_collection(grpc::CallbackServerContext* context,
+        const ::vectordb::DeleteCollectionRequest* request, ::vectordb::DeleteCollectionResponse* response);
+    grpc::Status list_collections(grpc::CallbackServerContext* context,
+        const ::vectordb::ListCollectionsRequest* request, ::vectordb::ListCollectionsResponse* response);
+    grpc::Status insert(grpc::CallbackServerContext* context,
+        const ::vectordb::InsertRequest* request, ::vectordb::InsertResponse* response);
+    grpc::Status batch_insert(grpc::CallbackServerContext* context,
+        const ::vectordb::BatchInsertRequest* request, ::vectordb::BatchInsertResponse* response);
+    grpc::Status remove(grpc::CallbackServerContext* context,
+        const ::vectordb::DeleteRequest* request, ::vectordb::DeleteResponse* response);
+    grpc::Status search(grpc::CallbackServerContext* context,
+        const ::vectordb::SearchRequest* request, ::vectordb::SearchResponse* response);
+    grpc::Status batch_search(grpc::CallbackServerContext* context,
+        const ::vectordb::BatchSearchRequest* request, ::vectordb::BatchSearchResponse* response);
+    grpc::Status get_vector(grpc::CallbackServerContext* context,
+        const ::vectordb::GetVectorRequest* request, ::vectordb::GetVectorResponse* response);
+    grpc::Status health(grpc::CallbackServerContext* context,
+        const ::vectordb::HealthRequest* request, ::vectordb::HealthResponse* response);
+    grpc::Status stats(grpc::CallbackServerContext* context,
+        const ::vectordb::StatsRequest* request, ::vectordb::StatsResponse* response);
+
     std::shared_ptr<VectorStorage> storage_;
+    std::shared_ptr<AdmissionController> admission_;
+    std::shared_ptr<LatencyMetrics> metrics_;
+    size_t max_stream_queries_;
+    std::unique_ptr<ThreadPool> workers_;
+
+    // Messages for the calls that carry vectors live on pooled arenas.
+    ArenaMessageAllocator<::vectordb::InsertRequest, ::vectordb::InsertResponse> insert_messages_;
+    ArenaMessageAllocator<::vectordb::BatchInsertRequest, ::vectordb::BatchInsertResponse> batch_insert_messages_;
+    ArenaMessageAllocator<::vectordb::SearchRequest, ::vectordb::SearchResponse> search_messages_;
+    ArenaMessageAllocator<::vectordb::BatchSearchRequest, ::vectordb::BatchSearchResponse> batch_search_messages_;
+    ArenaMessageAllocator<::vectordb::GetVectorRequest, ::vectordb::GetVectorResponse> get_vector_messages_;
     std::chrono::steady_clock::time_point start_time_;
-    std::atomic<uint64_t> total_searches_{0};
-    std::atomic<double> total_search_time_{0.0};
 };
 
 class GRPCServer {
 public:
-    GRPCServer(const std::string& address, std::shared_ptr<VectorStorage> storage);
+    GRPCServer(const std::string& address, std::shared_ptr<VectorStorage> storage,
+               std::shared_ptr<AdmissionController> admission = nullptr,
+               const GRPCServerConfig& config = {},
+               std::shared_ptr<LatencyMetrics> metrics = nullptr);
     ~GRPCServer();
 
+    // Listens on another address as well, e.g. "unix:/run/vector.sock".
+    // Call before run().
+    void add_listening_address(const std::string& address);
+
     void run();
     void shutdown();
 
 private:
-    std::string address_;
-    std::unique_ptr<grpc::Server> server_;
+    GRPCServerConfig config_;
+    std::vector<std::string> addresses_;
     std::unique_ptr<VectorServiceImpl> service_;
+    std::unique_ptr<grpc::Server> server_;
 };
 
 }
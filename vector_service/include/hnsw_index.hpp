@@ -6,6 +6,8 @@
 #include <shared_mutex>
 #include <memory>
 #include <atomic>
+#include <span>
+#include "deadline.hpp"
 #include <usearch/index.hpp>
 #include <usearch/index_dense.hpp>
 
@@ -25,16 +27,40 @@ struct HNSWConfig {
     DistanceMetric metric = DistanceMetric::Cosine;
 };
 
+// What the index keeps beside each vector. The values themselves live only
+// in the usearch index; read them with get_values() or ask search for them.
 struct VectorData {
+    std::string id;
+    std::unordered_map<std::string, std::string> metadata;
+};
+
+// A vector to insert that owns its values.
+struct VectorRecord {
     std::string id;
     std::vector<float> values;
     std::unordered_map<std::string, std::string> metadata;
 };
 
+// A vector to insert whose values are borrowed from the caller, typically
+// straight out of a decoded request; they are read during the insert only.
+struct VectorRef {
+    std::string id;
+    std::span<const float> values;
+    std::unordered_map<std::string, std::string> metadata;
+};
+
+// Exact-match metadata filter: a vector matches when its metadata has every
+// key with the same value. An empty filter matches everything.
+using MetadataFilter = std::unordered_map<std::string, std::string>;
+
+bool matches_filter(const VectorData& data, const MetadataFilter& filter);
+
 struct HNSWResult {
     std::string id;
     float distance;
     const VectorData* data;
+    // Copied out of the index only when the search asked for values.
+    std::vector<float> values;
 
     bool operator<(const HNSWResult& other) const {
         return distance < other.distance;
@@ -57,24 +83,45 @@ public:
     HNSWIndex(HNSWIndex&&) = delete;
     HNSWIndex& operator=(HNSWIndex&&) = delete;
 
-    std::string insert(const std::vector<float>& vector,
+    // Safe to call from many threads at once, alongside searches: usearch
+    // links each new vector into the graph concurrently, and only the id
+    // bookkeeping around it is serialized.
+    std::string insert(std::span<const float> vector,
                        const std::string& id = "",
                        const std::unordered_map<std::string, std::string>& metadata = {});
 
-    size_t batch_insert(const std::vector<VectorData>& vectors);
+    size_t batch_insert(const std::vector<VectorRecord>& vectors);
+    size_t batch_insert(std::span<const VectorRef> vectors);
 
     bool remove(const std::string& id);
 
-    std::vector<HNSWResult> search(const std::vector<float>& query,
+    // Both throw DeadlineExceeded once `deadline` expires; a batch checks it
+    // before every query, so abandoning one costs at most a query per thread.
+    //
+    // With a filter, only matching vectors are returned, and up to k of them
+    // whenever that many exist: the graph walk passes through vectors that
+    // don't match without counting them, and if it still comes back short
+    // the matches are scanned exhaustively.
+    //
+    // Each result's values are filled in only with `include_values`.
+    std::vector<HNSWResult> search(std::span<const float> query,
                                    size_t k,
-                                   size_t ef = 0) const;
+                                   size_t ef = 0,
+                                   const Deadline& deadline = {},
+                                   const MetadataFilter& filter = {},
+                                   bool include_values = false) const;
 
     std::vector<std::vector<HNSWResult>> batch_search(
         const std::vector<std::vector<float>>& queries,
         size_t k,
-        size_t ef = 0) const;
+        size_t ef = 0,
+        const Deadline& deadline = {},
+        bool include_values = false) const;
 
     const VectorData* get(const std::string& id) const;
+    // Copies a vector's values out of the index; false, leaving `values`
+    // empty, when there is no such id or it isn't in the graph yet.
+    bool get_values(const std::string& id, std::vector<float>& values) const;
 
     bool save(const std::string& path) const;
     bool load(const std::string& path);
@@ -95,9 +142,18 @@ private:
     std::unordered_map<key_t, VectorData> data_;
     std::unordered_map<std::string, key_t> id_to_key_;
 
+    // Locks are taken in declaration order. `write_mutex_` is shared by
+    // inserts and removes, exclusive while saving. `graph_mutex_` is shared
+    // by everything that uses index_, exclusive only to grow or reload it.
+    // `mutex_` guards data_ and id_to_key_ and is held briefly, except across
+    // a filtered search, whose predicate reads metadata.
+    mutable std::shared_mutex write_mutex_;
+    mutable std::shared_mutex graph_mutex_;
     mutable std::shared_mutex mutex_;
 
     std::string generate_id();
+    // Adds `vector` to the graph, growing it when full.
+    bool add_to_graph(key_t key, const float* vector);
 };
 
 }
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <memory>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include "compression.hpp"
+#include "deadline.hpp"
+
+namespace vectordb {
+
+// Growable receive buffer owned by one connection. Storage is left
+// uninitialised, and moving the buffer never relocates it, so views into a
+// request stay valid when the buffer is handed over to a worker.
+class ByteBuffer {
+public:
+    char* data() { return data_.get(); }
+    const char* data() const { return data_.get(); }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+
+    // Spare room after the filled bytes, e.g. for read(2).
+    char* tail() { return data_.get() + size_; }
+    size_t available() const { return capacity_ - size_; }
+    void commit(size_t n) { size_ += n; }
+
+    void reserve(size_t n);
+    void append(const char* bytes, size_t n);
+    void clear() { size_ = 0; }
+
+    std::string_view view(size_t offset, size_t len) const {
+        return std::string_view(data_.get() + offset, len);
+    }
+
+private:
+    std::unique_ptr<char[]> data_;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
+
+// The part of a request body still arriving on the socket. Only set for
+// uploads handed to a worker before they are complete (see
+// HTTPServer::Route::streamed_upload).
+class BodyReader {
+public:
+    virtual ~BodyReader() = default;
+
+    // Blocks until some of the remaining body is available. Returns the byte
+    // count, 0 at the end of the body, or -1 if the client stalls or leaves.
+    virtual long read(char* dest, size_t len) = 0;
+    virtual size_t remaining() const = 0;
+};
+
+struct HTTPRequest {
+    std::string method;
+    std::string path;
+    std::string version;
+    std::vector<std::pair<std::string, std::string>> headers;
+    size_t content_length = 0;
+
+    // `body` points into `buffer`, which holds the raw request as read from
+    // the socket; the body is never copied out of it. For a streamed upload
+    // `body` is only the prefix that arrived with the head and the rest comes
+    // from `body_reader`.
+    ByteBuffer buffer;
+    std::string_view body;
+    std::unique_ptr<BodyReader> body_reader;
+
+    // True when part of a streamed body was never read, which leaves the
+    // connection unusable for another request.
+    bool body_unread() const { return body_reader && body_reader->remaining() > 0; }
+
+    // From X-Request-Deadline (Unix time in milliseconds), and cancelled
+    // when the client disconnects.
+    Deadline deadline;
+
+    // Case-insensitive header lookup; nullptr when the header is absent.
+    const std::string* header(const std::string& name) const;
+
+    // Value of a query string parameter as sent, without percent-decoding;
+    // nullopt when the parameter is absent.
+    std::optional<std::string_view> query_param(std::string_view name) const;
+
+    // HTTP/1.1 defaults to persistent connections, HTTP/1.0 has to opt in.
+    bool keep_alive() const;
+};
+
+// Sink for a streamed response body.
+class ChunkWriter {
+public:
+    virtual ~ChunkWriter() = default;
+
+    // Sends one chunk, blocking while too much output is already queued.
+    // Returns false once the client has gone away; the producer should stop.
+    virtual bool write(std::string_view data) = 0;
+
+    // True when write() would block until the client reads more. Producers
+    // that are also reading the request body check this to avoid waiting on
+    // a client that only reads once its upload is done.
+    virtual bool congested() const = 0;
+};
+
+struct HTTPResponse {
+    int status = 200;
+    std::string content_type = "application/json";
+    std::string body;
+
+    // Coding already applied to `body`, or to be applied to each chunk of
+    // `stream`; see HTTPServer::encode_response.
+    compression::Encoding content_encoding = compression::Encoding::Identity;
+
+    // When set, the body is sent with chunked transfer encoding instead:
+    // the producer runs on the worker after the headers go out and each
+    // write becomes one chunk.
+    std::function<void(ChunkWriter& out)> stream;
+};
+
+const char* status_text(int code);
+
+// Incremental parser for one request. Feed it the bytes received so far on a
+// connection; it only rescans the part of the head it has not seen yet.
+class HTTPRequestParser {
+public:
+    enum class Status {
+        NeedMore,
+        Complete,
+        Error
+    };
+
+    static constexpr size_t MAX_HEAD_SIZE = 64 * 1024;
+
+    Status parse(const char* data, size_t len);
+
+    bool head_complete() const { return head_size_ > 0; }
+    size_t head_size() const { return head_size_; }
+
+    // Total bytes (head + body) the current request occupies once the head is known.
+    size_t message_size() const { return head_size_ + request_.content_length; }
+
+    HTTPRequest& request() { return request_; }
+
+    int error_code() const { return error_code_; }
+    const std::string& error_message() const { return error_message_; }
+
+    void reset();
+
+private:
+    HTTPRequest request_;
+    size_t scanned_ = 0;
+    size_t head_size_ = 0;
+    int error_code_ = 0;
+    std::string error_message_;
+
+    Status fail(int code, const std::string& message);
+    bool parse_head(const char* data, size_t len);
+};
+
+}
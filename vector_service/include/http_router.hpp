@@ -1,49 +1,77 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <functional>
-#include <unordered_map>
-#include <regex>
 
 namespace vectordb {
 
-struct RouteMatch {
-    bool matched = false;
-    std::vector<std::string> params;
-};
+// Path parameters captured by a match, in pattern order. They are views into
+// the path passed to HTTPRouter::match, so nothing is copied.
+class RouteParams {
+public:
+    static constexpr size_t MAX_PARAMS = 4;
+
+    std::string_view operator[](size_t i) const { return values_[i]; }
+    size_t size() const { return count_; }
+
+private:
+    friend class HTTPRouter;
 
-struct Route {
-    std::string method;
-    std::string pattern;
-    std::regex regex;
-    std::vector<std::string> param_names;
-    std::function<std::string(const std::vector<std::string>&, const std::string&)> handler;
+    std::array<std::string_view, MAX_PARAMS> values_;
+    size_t count_ = 0;
 };
 
+// Radix trie over route patterns, built once at startup. Patterns are
+// literal text plus ":name" (one path segment) and a trailing "*name" (the
+// rest of the path, slashes included), e.g. "/tenants/:tenant/:ns/faq/*id".
+// Literal edges win over parameters, and matching backtracks, so
+// "/tenants/t/stats" and "/tenants/t/stats/search" reach different routes.
+// The router maps to route ids; what a route does is up to the caller.
 class HTTPRouter {
 public:
-    void get(const std::string& pattern,
-             std::function<std::string(const std::vector<std::string>&, const std::string&)> handler);
+    static constexpr uint32_t NO_ROUTE = UINT32_MAX;
 
-    void post(const std::string& pattern,
-              std::function<std::string(const std::vector<std::string>&, const std::string&)> handler);
+    HTTPRouter();
+    ~HTTPRouter();
 
-    void put(const std::string& pattern,
-             std::function<std::string(const std::vector<std::string>&, const std::string&)> handler);
+    HTTPRouter(const HTTPRouter&) = delete;
+    HTTPRouter& operator=(const HTTPRouter&) = delete;
+    HTTPRouter(HTTPRouter&&) = default;
+    HTTPRouter& operator=(HTTPRouter&&) = default;
 
-    void del(const std::string& pattern,
-             std::function<std::string(const std::vector<std::string>&, const std::string&)> handler);
+    // Throws std::invalid_argument for a malformed pattern, an unsupported
+    // method, or a method and pattern that are already registered.
+    void add(std::string_view method, std::string_view pattern, uint32_t route_id);
 
-    std::string route(const std::string& method, const std::string& path, const std::string& body);
+    // Returns the route id, or NO_ROUTE. Any query string is ignored.
+    uint32_t match(std::string_view method, std::string_view path, RouteParams& params) const;
 
 private:
-    std::vector<Route> routes_;
+    enum Method : uint8_t { GET, POST, PUT, DELETE, METHOD_COUNT };
+
+    struct Node {
+        std::string prefix;
+        std::string first_bytes;  // first byte of each literal child, in order
+        std::vector<std::unique_ptr<Node>> children;
+        std::unique_ptr<Node> param;
+        std::unique_ptr<Node> catch_all;
+        std::array<uint32_t, METHOD_COUNT> routes;
+
+        Node();
+    };
+
+    static int method_index(std::string_view method);
 
-    void add_route(const std::string& method, const std::string& pattern,
-                   std::function<std::string(const std::vector<std::string>&, const std::string&)> handler);
+    Node* insert_literal(Node* node, std::string_view text);
+    bool match_node(const Node& node, std::string_view rest, int method,
+                    RouteParams& params, uint32_t& route) const;
 
-    std::pair<std::regex, std::vector<std::string>> compile_pattern(const std::string& pattern);
+    std::unique_ptr<Node> root_;
 };
 
 }
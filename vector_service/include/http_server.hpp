@@ -1,69 +1,223 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <memory>
 #include <functional>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
 #include "vector_storage.hpp"
+#include "thread_pool.hpp"
+#include "http_request.hpp"
+#include "http_router.hpp"
+#include "json_parser.hpp"
+#include "json_writer.hpp"
+#include "admission.hpp"
+#include "latency_histogram.hpp"
 
 namespace vectordb {
 
+enum class IOBackend : uint8_t { Epoll, IoUring };
+
+struct HTTPServerConfig {
+    int port = 50052;
+    size_t num_workers = std::thread::hardware_concurrency();
+    std::chrono::seconds idle_timeout{75};
+    size_t max_requests_per_connection = 1000;
+    // Largest request body accepted, as sent; larger ones get a 413 before
+    // any of the body is read. Streamed uploads (NDJSON ingest) are exempt.
+    size_t max_body_size = 1024ull * 1024 * 1024;
+    // Also listen on this Unix domain socket when set, for clients on the same host.
+    std::string unix_socket;
+    // Reactor threads, each with its own SO_REUSEPORT listener, epoll set
+    // and connections; the kernel spreads new connections across them.
+    size_t num_shards = 1;
+    // CPU each shard's reactor is pinned to, reused round-robin when there
+    // are more shards than entries. Empty leaves placement to the scheduler.
+    std::vector<int> shard_cpus;
+    // io_uring batches a shard's accepts, receives and sends into one
+    // syscall per loop turn. A shard falls back to epoll when the kernel
+    // can't provide a ring.
+    IOBackend io_backend = IOBackend::Epoll;
+};
+
 class HTTPServer {
 public:
-    HTTPServer(int port, std::shared_ptr<VectorStorage> storage);
+    // Without an admission controller the server uses one with default
+    // limits, and likewise keeps its own latency metrics unless given some.
+    HTTPServer(const HTTPServerConfig& config, std::shared_ptr<VectorStorage> storage,
+               std::shared_ptr<AdmissionController> admission = nullptr,
+               std::shared_ptr<LatencyMetrics> metrics = nullptr);
     ~HTTPServer();
 
     void start();
     void stop();
 
+    struct ShardStats {
+        size_t shard;
+        int cpu;
+        uint64_t accepted;
+        uint64_t requests;
+        size_t open_connections;
+    };
+    std::vector<ShardStats> shard_stats() const;
+
 private:
-    int port_;
+    struct Connection;
+    struct Shard;
+    struct ResultFields;
+    class ConnectionWriter;
+    class SocketReader;
+
+    HTTPServerConfig config_;
     std::shared_ptr<VectorStorage> storage_;
+    std::shared_ptr<AdmissionController> admission_;
+    std::shared_ptr<LatencyMetrics> metrics_;
     std::atomic<bool> running_{false};
-    std::thread server_thread_;
-
-    void run_server();
-
-    std::string handle_request(const std::string& method,
-                               const std::string& path,
-                               const std::string& body);
-
-    std::string route_tenant_endpoints(const std::string& method,
-                                        const std::string& path,
-                                        const std::string& body);
-
-    std::string handle_search(const std::string& body);
-    std::string handle_batch_search(const std::string& body);
-    std::string handle_search_with_filter(const std::string& body);
-    std::string handle_insert(const std::string& body);
-    std::string handle_batch_insert(const std::string& body);
-    std::string handle_delete_vector(const std::string& collection, const std::string& id);
-    std::string handle_get_vector(const std::string& collection, const std::string& id);
-    std::string handle_update_vector(const std::string& collection, const std::string& id, const std::string& body);
-    std::string handle_create_collection(const std::string& body);
-    std::string handle_delete_collection(const std::string& name);
-    std::string handle_list_collections();
-    std::string handle_health();
-    std::string handle_stats(const std::string& collection);
-    std::string handle_index_stats(const std::string& collection);
-    std::string handle_count(const std::string& collection);
-    std::string handle_save(const std::string& collection);
-
-    std::string handle_list_namespaces(const std::string& tenant_id);
-    std::string handle_create_namespace(const std::string& tenant_id, const std::string& body);
-    std::string handle_add_faq(const std::string& tenant_id, const std::string& ns, const std::string& body);
-    std::string handle_bulk_faq(const std::string& tenant_id, const std::string& ns, const std::string& body);
-    std::string handle_namespace_search(const std::string& tenant_id, const std::string& ns, const std::string& body);
-    std::string handle_tenant_search(const std::string& tenant_id, const std::string& body);
-    std::string handle_get_faq(const std::string& tenant_id, const std::string& ns, const std::string& faq_id);
-    std::string handle_delete_faq(const std::string& tenant_id, const std::string& ns, const std::string& faq_id);
-    std::string handle_update_faq(const std::string& tenant_id, const std::string& ns, const std::string& faq_id, const std::string& body);
-    std::string handle_namespace_stats(const std::string& tenant_id, const std::string& ns);
-    std::string handle_tenant_stats(const std::string& tenant_id);
-
-    std::string json_response(int code, const std::string& body);
-    std::string error_response(int code, const std::string& message);
+    std::unique_ptr<ThreadPool> workers_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    // Output handed from workers to the reactor. A streamed response arrives
+    // as several entries; only the last one frees the connection.
+    struct Completion {
+        std::shared_ptr<Connection> conn;
+        std::string data;
+        // Queued after data as a buffer of its own: a response body, sent
+        // without being copied in behind the head.
+        std::string body;
+        bool last = true;
+        bool abort = false;
+    };
+
+    void run_shard(Shard& shard);
+    void run_epoll_loop(Shard& shard);
+    bool open_listener(Shard& shard);
+    bool open_unix_listener(Shard& shard);
+    void accept_connections(Shard& shard, int listen_fd);
+    std::shared_ptr<Connection> add_connection(Shard& shard, int client_fd, bool tcp);
+    void on_readable(const std::shared_ptr<Connection>& conn);
+    void on_received(const std::shared_ptr<Connection>& conn, size_t bytes);
+    void process_input(const std::shared_ptr<Connection>& conn);
+    void dispatch(const std::shared_ptr<Connection>& conn);
+    void complete(const std::shared_ptr<Connection>& conn, std::string data,
+                  bool last = true, bool abort = false, std::string body = {});
+    // Queues a response from the reactor thread itself; the caller flushes.
+    void queue_response(const std::shared_ptr<Connection>& conn, HTTPResponse response,
+                        bool keep_alive);
+    void stream_response(const std::shared_ptr<Connection>& conn, const HTTPResponse& response,
+                         bool keep_alive, const HTTPRequest& request);
+    void drain_completions(Shard& shard);
+    void flush(const std::shared_ptr<Connection>& conn);
+    void close_connection(const std::shared_ptr<Connection>& conn);
+    void close_idle_connections(Shard& shard);
+
+    // io_uring backend. Completions come back through uring_complete(),
+    // which feeds the same on_received() / flush() paths as epoll.
+    bool setup_uring(Shard& shard);
+    void run_uring_loop(Shard& shard);
+    void uring_complete(Shard& shard, uint64_t user_data, int result);
+    void uring_accept(Shard& shard, int listen_fd);
+    void uring_read_wake(Shard& shard);
+    void uring_recv(const std::shared_ptr<Connection>& conn);
+    void uring_send(const std::shared_ptr<Connection>& conn);
+    void uring_watch_hangup(const std::shared_ptr<Connection>& conn);
+    void uring_release_buffer(const std::shared_ptr<Connection>& conn);
+
+    // What a route handler gets: the request, its parsed JSON body (missing
+    // for binary and raw bodies) and the path parameters.
+    struct RouteContext {
+        const HTTPRequest& request;
+        const json::Value& body;
+        const RouteParams& params;
+    };
+    using RouteHandler = HTTPResponse (*)(HTTPServer& server, const RouteContext& context);
+
+    // Where a route finds the collection it is charged to for admission.
+    enum class RouteScope : uint8_t { None, Param, BodyCollection, BodyName };
+
+    struct Route {
+        RouteHandler handler = nullptr;
+        // Takes application/octet-stream bodies (see binary_protocol.hpp).
+        RouteHandler binary_handler = nullptr;
+        RouteScope scope = RouteScope::BodyCollection;
+        // The handler reads request.body itself; it is not parsed as JSON.
+        bool raw_body = false;
+        // Dispatched once the head is parsed; the body follows through request.body_reader.
+        bool streamed_upload = false;
+        bool admission_exempt = false;
+        // "METHOD /pattern", what the route's latency is recorded under; set by add_route.
+        std::string name;
+    };
+
+    HTTPRouter router_;
+    std::vector<Route> routes_;
+
+    void build_routes();
+    void add_route(std::string_view method, std::string_view pattern, const Route& route);
+    const Route* find_route(const HTTPRequest& request, RouteParams& params) const;
+
+    // Sets `collection` to the one the request is charged to, once known.
+    HTTPResponse handle_request(HTTPRequest& request, AdmissionController::Ticket& ticket,
+                                std::string& collection);
+
+    // Undoes the request's Content-Encoding in place. On failure fills in the
+    // error response and returns false.
+    bool decode_body(HTTPRequest& request, const Route& route, HTTPResponse& error);
+    // Compresses the response with the best coding the client accepts.
+    static void encode_response(const HTTPRequest& request, HTTPResponse& response);
+
+    HTTPResponse handle_search(const json::Value& body, const ResultFields& fields,
+                               const Deadline& deadline);
+    HTTPResponse handle_batch_search(const json::Value& body, const ResultFields& fields,
+                                     const Deadline& deadline);
+    HTTPResponse handle_search_with_filter(const json::Value& body, const ResultFields& fields,
+                                           const Deadline& deadline);
+    HTTPResponse handle_insert(const json::Value& body);
+    HTTPResponse handle_binary_search(std::string_view body, bool batch, const Deadline& deadline);
+    HTTPResponse handle_binary_insert(std::string_view body, bool batch);
+    HTTPResponse handle_batch_insert(const json::Value& body);
+    HTTPResponse handle_ingest(const std::string& collection, const HTTPRequest& request);
+    HTTPResponse handle_delete_vector(const std::string& collection, const std::string& id);
+    HTTPResponse handle_get_vector(const std::string& collection, const std::string& id);
+    HTTPResponse handle_update_vector(const std::string& collection, const std::string& id, const json::Value& body);
+    HTTPResponse handle_create_collection(const json::Value& body);
+    HTTPResponse handle_delete_collection(const std::string& name);
+    HTTPResponse handle_list_collections();
+    HTTPResponse handle_health();
+    HTTPResponse handle_admission_stats();
+    HTTPResponse handle_shard_stats();
+    HTTPResponse handle_latency_stats(std::optional<std::string_view> collection);
+    HTTPResponse handle_stats(const std::string& collection);
+    HTTPResponse handle_index_stats(const std::string& collection);
+    HTTPResponse handle_count(const std::string& collection);
+    HTTPResponse handle_save(const std::string& collection);
+
+    HTTPResponse handle_list_namespaces(const std::string& tenant_id);
+    HTTPResponse handle_create_namespace(const std::string& tenant_id, const json::Value& body);
+    HTTPResponse handle_add_faq(const std::string& tenant_id, const std::string& ns, const json::Value& body);
+    HTTPResponse handle_bulk_faq(const std::string& tenant_id, const std::string& ns, const json::Value& body);
+    HTTPResponse handle_namespace_search(const std::string& tenant_id, const std::string& ns, const json::Value& body,
+                                         const Deadline& deadline);
+    HTTPResponse handle_tenant_search(const std::string& tenant_id, const json::Value& body,
+                                      const Deadline& deadline);
+    HTTPResponse handle_get_faq(const std::string& tenant_id, const std::string& ns, const std::string& faq_id);
+    HTTPResponse handle_delete_faq(const std::string& tenant_id, const std::string& ns, const std::string& faq_id);
+    HTTPResponse handle_update_faq(const std::string& tenant_id, const std::string& ns, const std::string& faq_id, const json::Value& body);
+    HTTPResponse handle_namespace_stats(const std::string& tenant_id, const std::string& ns);
+    HTTPResponse handle_tenant_stats(const std::string& tenant_id);
+
+    HTTPResponse json_response(int code, std::string body);
+    HTTPResponse json_response(int code, const json::Writer& body);
+    HTTPResponse error_response(int code, const std::string& message);
+    HTTPResponse rejection_response(AdmissionController::Rejection rejection,
+                                    std::string_view collection);
+    // Status line and headers; the body is sent after it as is.
+    static std::string serialize_head(const HTTPResponse& response, bool keep_alive,
+                                      const HTTPServerConfig& config);
 };
 
 }
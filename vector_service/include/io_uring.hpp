@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define VECTORDB_HAVE_IO_URING 1
+#endif
+
+namespace vectordb {
+
+#ifdef VECTORDB_HAVE_IO_URING
+
+// Thin io_uring ring over the raw syscalls, so the server needs no liburing.
+// Used by one thread at a time: entries are queued with get_sqe() and all go
+// to the kernel in the same io_uring_enter() that waits for completions.
+class IoUring {
+public:
+    // Returns nullptr with `error` set when the kernel can't provide a ring
+    // with every op in `required_ops` (IORING_OP_* values).
+    static std::unique_ptr<IoUring> create(unsigned entries,
+                                           std::initializer_list<int> required_ops,
+                                           std::string& error);
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // A zeroed submission entry. When the queue is full the queued entries
+    // are submitted first, so this never fails.
+    io_uring_sqe* get_sqe();
+
+    // Submits everything queued and waits until at least one completion is
+    // ready or `timeout` passes.
+    void submit_and_wait(std::chrono::milliseconds timeout);
+
+    // Calls fn(const io_uring_cqe&) for every ready completion.
+    template <typename Fn>
+    void for_each_completion(Fn&& fn) {
+        unsigned head = *cq_head_;
+        while (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+            io_uring_cqe cqe = cqes_[head & cq_mask_];
+            __atomic_store_n(cq_head_, ++head, __ATOMIC_RELEASE);
+            fn(cqe);
+        }
+    }
+
+    // Sparse table of registered buffers for IORING_OP_READ_FIXED. False
+    // when the kernel can't register buffers this way.
+    bool register_buffer_slots(unsigned count);
+    unsigned buffer_slots() const { return buffer_slots_; }
+    // Points a slot at `data`; a null `data` empties it.
+    bool set_buffer(unsigned slot, void* data, size_t size);
+
+private:
+    IoUring() = default;
+    void submit(unsigned wait_nr, std::chrono::milliseconds timeout);
+
+    int fd_ = -1;
+    void* sq_ring_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    void* cq_ring_ = nullptr;
+    size_t cq_ring_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned sqe_tail_ = 0;
+
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+
+    unsigned buffer_slots_ = 0;
+};
+
+#else
+
+// Built without io_uring headers: creating a ring always fails.
+class IoUring {
+public:
+    static std::unique_ptr<IoUring> create(unsigned, std::initializer_list<int>, std::string& error) {
+        error = "built without io_uring support";
+        return nullptr;
+    }
+};
+
+#endif
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ostream>
+
+namespace vectordb {
+namespace json {
+
+// Parses one number starting at `first`. Returns the end of the number, or
+// `first` if there is none. Plain decimals (what embedding clients send) take
+// an eight-digits-at-a-time path and a single exact double operation; long
+// mantissas, large exponents and rounding ties defer to std::from_chars, so
+// the result always matches a correctly rounded strtof.
+const char* parse_float(const char* first, const char* last, float& value);
+
+// Parses the array whose '[' is at json[bracket_pos], appending its numbers
+// to `out`. Returns the offset just past the closing ']', or npos if the
+// array is unterminated or holds anything other than numbers.
+size_t parse_float_array(std::string_view json, size_t bracket_pos, std::vector<float>& out);
+
+// Shortest text that reads back as the same float (std::to_chars).
+// JSON has no NaN or infinity, so those are written as null.
+struct FloatText {
+    char data[24];
+    uint8_t size = 0;
+
+    std::string_view view() const { return {data, size}; }
+};
+
+FloatText format_float(float value);
+
+inline std::ostream& operator<<(std::ostream& os, const FloatText& text) {
+    return os.write(text.data, text.size);
+}
+
+void append_float(std::string& out, float value);
+
+// Appends [v0,v1,...].
+void append_float_array(std::string& out, const float* values, size_t count);
+
+}
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vectordb {
+namespace json {
+
+enum class Type : uint8_t { Null, Bool, Number, String, Array, Object };
+
+class Document;
+
+// Read-only handle to one node of a parsed Document. A default-constructed
+// Value stands for "missing": lookups on it keep returning missing values and
+// the typed getters return their fallback, so handlers can chain lookups
+// without checking every step.
+class Value {
+public:
+    Value() = default;
+
+    explicit operator bool() const { return doc_ != nullptr; }
+    Type type() const;
+    bool is_null() const { return type() == Type::Null; }
+    bool is_string() const { return doc_ && type() == Type::String; }
+    bool is_number() const { return doc_ && type() == Type::Number; }
+    bool is_array() const { return doc_ && type() == Type::Array; }
+    bool is_object() const { return doc_ && type() == Type::Object; }
+
+    // Object member lookup; the first match wins for duplicate keys.
+    Value operator[](std::string_view key) const;
+
+    std::string_view string_view(std::string_view fallback = {}) const;
+    std::string string(std::string_view fallback = {}) const;
+    int64_t get_int(int64_t fallback = 0) const;
+    float get_float(float fallback = 0.0f) const;
+    bool get_bool(bool fallback = false) const;
+
+    // Decoded text for strings, the source text for anything else.
+    std::string_view text() const;
+
+    // Element count for arrays, member count for objects.
+    size_t size() const;
+
+    // Arrays made only of numbers are parsed straight into floats during
+    // tokenizing and are read back through these rather than element-wise.
+    bool is_float_array() const;
+    std::span<const float> floats() const;
+    std::vector<float> float_vector() const { auto f = floats(); return {f.begin(), f.end()}; }
+
+    template <typename Fn>
+    void for_each_element(Fn&& fn) const;
+
+    template <typename Fn>
+    void for_each_member(Fn&& fn) const;
+
+private:
+    friend class Document;
+    Value(const Document* doc, uint32_t index) : doc_(doc), index_(index) {}
+
+    const Document* doc_ = nullptr;
+    uint32_t index_ = 0;
+};
+
+// One-pass tokenizer producing a flat tape of nodes. Strings without escapes
+// are views into the input, so the input must outlive the Document; escaped
+// strings are decoded into storage owned by the Document.
+class Document {
+public:
+    bool parse(std::string_view input);
+    const std::string& error() const { return error_; }
+    Value root() const { return nodes_.empty() ? Value() : Value(this, 0); }
+
+private:
+    friend class Value;
+
+    struct Node {
+        Type type = Type::Null;
+        bool flag = false;       // Bool value; Array: packed floats
+        uint32_t next = 0;       // index just past this node's subtree
+        uint32_t size = 0;       // elements, members, or packed floats
+        uint32_t offset = 0;     // packed arrays: first float in floats_
+        std::string_view text;
+    };
+
+    class Parser;
+
+    std::vector<Node> nodes_;
+    std::vector<float> floats_;
+    std::deque<std::string> decoded_;
+    std::string error_;
+};
+
+template <typename Fn>
+void Value::for_each_element(Fn&& fn) const {
+    if (!is_array() || is_float_array()) return;
+    const auto& nodes = doc_->nodes_;
+    uint32_t end = nodes[index_].next;
+    for (uint32_t i = index_ + 1; i < end; i = nodes[i].next) {
+        fn(Value(doc_, i));
+    }
+}
+
+template <typename Fn>
+void Value::for_each_member(Fn&& fn) const {
+    if (!is_object()) return;
+    const auto& nodes = doc_->nodes_;
+    uint32_t end = nodes[index_].next;
+    for (uint32_t i = index_ + 1; i < end; i = nodes[i + 1].next) {
+        fn(nodes[i].text, Value(doc_, i + 1));
+    }
+}
+
+}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "json_number.hpp"
+
+namespace vectordb {
+namespace json {
+
+// Appends JSON text to a string. Structure is written with raw(); values
+// go through string() and number(), which escape and format them.
+//
+//   json::Writer w;
+//   w.raw("{\"id\":").string(id).raw(",\"score\":").number(score).raw("}");
+//
+// A default-constructed Writer fills a per-thread buffer that keeps its
+// capacity between responses, so a body is built without reallocating as it
+// grows. Taking the result (e.g. as a response body) still copies it out
+// once, into a buffer of exactly its size. A Writer made while another is
+// alive on the same thread gets a buffer of its own.
+class Writer {
+public:
+    Writer();
+    // Appends to `out` instead.
+    explicit Writer(std::string& out) : out_(&out) {}
+    ~Writer();
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    Writer& raw(std::string_view text) {
+        out_->append(text);
+        return *this;
+    }
+
+    Writer& raw(char c) {
+        out_->push_back(c);
+        return *this;
+    }
+
+    // Quoted string, escaping quotes, backslashes and control characters.
+    // Other bytes, including UTF-8 sequences, are copied through as they are.
+    Writer& string(std::string_view text);
+
+    template <std::integral T>
+    Writer& number(T value) {
+        char buf[24];
+        auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+        out_->append(buf, end);
+        return *this;
+    }
+
+    // Shortest round-trip form; NaN and infinity become null.
+    Writer& number(float value) {
+        out_->append(format_float(value).view());
+        return *this;
+    }
+
+    Writer& boolean(bool value) { return raw(value ? "true" : "false"); }
+
+    // [v0,v1,...]
+    Writer& float_array(const float* values, size_t count) {
+        append_float_array(*out_, values, count);
+        return *this;
+    }
+
+    // Metadata values are stored as strings and written as JSON strings.
+    Writer& string_map(const std::unordered_map<std::string, std::string>& map);
+
+    std::string_view view() const { return *out_; }
+    size_t size() const { return out_->size(); }
+    void clear() { out_->clear(); }
+
+private:
+    std::string* out_;
+    std::string owned_;
+    bool scratch_ = false;
+};
+
+// Appends `text` as a quoted JSON string; see Writer::string().
+void append_quoted(std::string& out, std::string_view text);
+
+}
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vectordb {
+
+// Request latencies in log-linear buckets, HDR-style: exact below 16 us,
+// then 16 buckets per power of two, so any percentile read back is within
+// about 3% of the true value, up to about 70 minutes.
+//
+// Recording touches only the calling thread's shard with relaxed atomics;
+// shards are summed when the histogram is read, so a hot endpoint never has
+// all its threads contending on one counter.
+class LatencyHistogram {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr size_t SUB_BUCKET_BITS = 4;
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+    static constexpr size_t MAX_EXPONENT = 32;
+    static constexpr size_t BUCKETS = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS) * SUB_BUCKETS;
+    static constexpr size_t SHARDS = 16;
+
+    struct Summary {
+        uint64_t count = 0;
+        double mean_ms = 0;
+        double p50_ms = 0;
+        double p95_ms = 0;
+        double p99_ms = 0;
+        double p999_ms = 0;
+        double max_ms = 0;
+    };
+
+    LatencyHistogram() = default;
+    ~LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(clock::duration elapsed);
+    void record_us(uint64_t micros);
+
+    // Merges the shards. Concurrent records may or may not be included.
+    Summary summary() const;
+
+    static size_t bucket_of(uint64_t micros);
+    // The value a bucket reports: its midpoint.
+    static uint64_t bucket_value(size_t bucket);
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, BUCKETS> counts{};
+        std::atomic<uint64_t> sum_us{0};
+        std::atomic<uint64_t> max_us{0};
+    };
+
+    Shard& local_shard();
+
+    // Allocated by the first thread to record into each slot, so an
+    // endpoint only a few threads serve stays small.
+    std::array<std::atomic<Shard*>, SHARDS> shards_{};
+};
+
+// Latency histograms per collection and endpoint, shared by the HTTP and
+// gRPC servers. Calls that name no collection are kept under "".
+class LatencyMetrics {
+public:
+    struct Entry {
+        std::string collection;
+        std::string endpoint;
+        LatencyHistogram::Summary latency;
+    };
+
+    // Collections past `max_collections` are counted together under
+    // OTHER_COLLECTION, so requests naming arbitrary collections can't grow
+    // the table without bound.
+    static constexpr std::string_view OTHER_COLLECTION = "(other)";
+
+    explicit LatencyMetrics(size_t max_collections = 1024) : max_collections_(max_collections) {}
+
+    void record(std::string_view collection, std::string_view endpoint,
+                LatencyHistogram::clock::duration elapsed);
+
+    // Every collection, or only `collection` when given, ordered by name.
+    std::vector<Entry> snapshot() const;
+    std::vector<Entry> snapshot(std::string_view collection) const;
+
+private:
+    using Endpoints = std::map<std::string, std::unique_ptr<LatencyHistogram>, std::less<>>;
+
+    static void append(std::vector<Entry>& out, const std::string& collection, const Endpoints& endpoints);
+
+    size_t max_collections_;
+    mutable std::shared_mutex mutex_;
+    std::map<std::string, Endpoints, std::less<>> collections_;
+};
+
+}
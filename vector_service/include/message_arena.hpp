@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include <google/protobuf/arena.h>
+#include <grpcpp/support/message_allocator.h>
+
+namespace vectordb {
+
+// Puts a unary RPC's request and response on a protobuf arena, so the
+// results, value arrays and metadata maps a handler builds come out of a few
+// blocks and are freed together when the call completes, instead of one heap
+// allocation each.
+//
+// Arenas are reset and pooled between calls. Each keeps an inline first
+// block that survives the reset, so a typical call takes nothing from the
+// heap for its messages; a large one allocates a handful of blocks.
+template <typename Request, typename Response>
+class ArenaMessageAllocator final : public grpc::MessageAllocator<Request, Response> {
+public:
+    static constexpr size_t INITIAL_BLOCK_SIZE = 16 * 1024;
+
+    // Holders beyond `max_pooled` are freed on release rather than kept.
+    explicit ArenaMessageAllocator(size_t max_pooled = 64) : max_pooled_(max_pooled) {}
+
+    ~ArenaMessageAllocator() override {
+        for (Holder* holder : pool_) delete holder;
+    }
+
+    ArenaMessageAllocator(const ArenaMessageAllocator&) = delete;
+    ArenaMessageAllocator& operator=(const ArenaMessageAllocator&) = delete;
+
+    grpc::MessageHolder<Request, Response>* AllocateMessages() override {
+        Holder* holder = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!pool_.empty()) {
+                holder = pool_.back();
+                pool_.pop_back();
+            }
+        }
+        if (!holder) holder = new Holder(*this);
+        holder->create_messages();
+        return holder;
+    }
+
+private:
+    class Holder final : public grpc::MessageHolder<Request, Response> {
+    public:
+        explicit Holder(ArenaMessageAllocator& owner) : owner_(owner), arena_(options()) {}
+
+        void create_messages() {
+            this->set_request(google::protobuf::Arena::CreateMessage<Request>(&arena_));
+            this->set_response(google::protobuf::Arena::CreateMessage<Response>(&arena_));
+        }
+
+        void Release() override {
+            arena_.Reset();
+            owner_.recycle(this);
+        }
+
+    private:
+        google::protobuf::ArenaOptions options() {
+            google::protobuf::ArenaOptions options;
+            options.initial_block = block_;
+            options.initial_block_size = sizeof(block_);
+            return options;
+        }
+
+        ArenaMessageAllocator& owner_;
+        alignas(16) char block_[INITIAL_BLOCK_SIZE];
+        google::protobuf::Arena arena_;
+    };
+
+    void recycle(Holder* holder) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pool_.size() < max_pooled_) {
+                pool_.push_back(holder);
+                return;
+            }
+        }
+        delete holder;
+    }
+
+    std::mutex mutex_;
+    std::vector<Holder*> pool_;
+    size_t max_pooled_;
+};
+
+}
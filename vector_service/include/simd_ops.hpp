@@ -29,6 +29,12 @@ void subtract_vectors(const float* a, const float* b, float* result, size_t dim)
 
 void scale_vector(const float* vec, float scalar, float* result, size_t dim);
 
+// Widens IEEE half-precision values (stored as their bit patterns) to float.
+void f16_to_f32(const uint16_t* in, float* out, size_t dim);
+
+// out[i] = in[i] * scale, for int8-quantized vectors.
+void i8_to_f32(const int8_t* in, float scale, float* out, size_t dim);
+
 #if defined(USE_AVX512)
 
 inline float dot_product_avx512(const float* a, const float* b, size_t dim) {
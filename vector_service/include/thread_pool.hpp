@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vectordb {
+
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Runs every queued task, then joins the workers.
+    void shutdown();
+
+    size_t size() const { return workers_.size(); }
+    size_t queue_depth() const;
+
+private:
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+
+    void worker_loop();
+};
+
+}
@@ -39,30 +39,42 @@ public:
 
     bool collection_exists(const std::string& name) const;
 
+    // The collection's vector dimension, or nullopt when it doesn't exist.
+    std::optional<size_t> dimension(const std::string& name) const;
+
     std::optional<CollectionStats> get_stats(const std::string& name) const;
 
     std::string insert(const std::string& collection,
-                       const std::vector<float>& vector,
+                       std::span<const float> vector,
                        const std::string& id = "",
                        const std::unordered_map<std::string, std::string>& metadata = {});
 
     size_t batch_insert(const std::string& collection,
-                        const std::vector<VectorData>& vectors);
+                        const std::vector<VectorRecord>& vectors);
+    size_t batch_insert(const std::string& collection,
+                        std::span<const VectorRef> vectors);
 
     bool remove(const std::string& collection, const std::string& id);
 
     std::vector<HNSWResult> search(const std::string& collection,
-                                     const std::vector<float>& query,
+                                     std::span<const float> query,
                                      size_t k,
-                                     size_t ef = 0) const;
+                                     size_t ef = 0,
+                                     const Deadline& deadline = {},
+                                     const MetadataFilter& filter = {},
+                                     bool include_values = false) const;
 
     std::vector<std::vector<HNSWResult>> batch_search(
         const std::string& collection,
         const std::vector<std::vector<float>>& queries,
         size_t k,
-        size_t ef = 0) const;
+        size_t ef = 0,
+        const Deadline& deadline = {},
+        bool include_values = false) const;
 
     const VectorData* get(const std::string& collection, const std::string& id) const;
+    bool get_values(const std::string& collection, const std::string& id,
+                    std::vector<float>& values) const;
 
     bool save_all() const;
     bool load_all();
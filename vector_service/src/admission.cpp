@@ -0,0 +1,107 @@
+#include "admission.hpp"
+#include <algorithm>
+
+namespace vectordb {
+
+std::string_view tenant_of(std::string_view collection) {
+    size_t separator = collection.find("__");
+    return separator == std::string_view::npos ? collection : collection.substr(0, separator);
+}
+
+AdmissionController::Ticket::Ticket(Ticket&& other) noexcept
+    : owner_(other.owner_), tenant_(std::move(other.tenant_)) {
+    other.owner_ = nullptr;
+}
+
+AdmissionController::Ticket& AdmissionController::Ticket::operator=(Ticket&& other) noexcept {
+    if (this != &other) {
+        release();
+        owner_ = other.owner_;
+        tenant_ = std::move(other.tenant_);
+        other.owner_ = nullptr;
+    }
+    return *this;
+}
+
+AdmissionController::Ticket::~Ticket() {
+    release();
+}
+
+void AdmissionController::Ticket::release() {
+    if (owner_) {
+        owner_->release(tenant_);
+        owner_ = nullptr;
+    }
+}
+
+AdmissionController::AdmissionController(const AdmissionConfig& config)
+    : config_(config) {
+}
+
+AdmissionController::Ticket AdmissionController::admit(Rejection& rejection) {
+    size_t pending = pending_.fetch_add(1, std::memory_order_relaxed);
+    if (config_.max_pending > 0 && pending >= config_.max_pending) {
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        rejected_overloaded_.fetch_add(1, std::memory_order_relaxed);
+        rejection = Rejection::Overloaded;
+        return {};
+    }
+
+    admitted_.fetch_add(1, std::memory_order_relaxed);
+    rejection = Rejection::None;
+    Ticket ticket;
+    ticket.owner_ = this;
+    return ticket;
+}
+
+bool AdmissionController::admit_tenant(Ticket& ticket, std::string_view collection,
+                                       Rejection& rejection) {
+    rejection = Rejection::None;
+    std::string_view tenant = tenant_of(collection);
+    if (!ticket || !ticket.tenant_.empty() || tenant.empty()) return true;
+
+    std::lock_guard lock(tenants_mutex_);
+    auto it = tenants_.try_emplace(std::string(tenant)).first;
+    TenantState& state = it->second;
+    if (config_.max_tenant_in_flight > 0 && state.in_flight >= config_.max_tenant_in_flight) {
+        ++state.rejected;
+        rejected_tenant_.fetch_add(1, std::memory_order_relaxed);
+        rejection = Rejection::TenantLimit;
+        return false;
+    }
+    ++state.in_flight;
+    ticket.tenant_ = it->first;
+    return true;
+}
+
+void AdmissionController::release(const std::string& tenant) {
+    pending_.fetch_sub(1, std::memory_order_relaxed);
+    if (tenant.empty()) return;
+
+    std::lock_guard lock(tenants_mutex_);
+    auto it = tenants_.find(tenant);
+    if (it != tenants_.end() && --it->second.in_flight == 0) {
+        tenants_.erase(it);
+    }
+}
+
+AdmissionController::Stats AdmissionController::stats() const {
+    Stats stats;
+    stats.pending = pending_.load(std::memory_order_relaxed);
+    stats.max_pending = config_.max_pending;
+    stats.max_tenant_in_flight = config_.max_tenant_in_flight;
+    stats.admitted = admitted_.load(std::memory_order_relaxed);
+    stats.rejected_overloaded = rejected_overloaded_.load(std::memory_order_relaxed);
+    stats.rejected_tenant = rejected_tenant_.load(std::memory_order_relaxed);
+
+    std::lock_guard lock(tenants_mutex_);
+    stats.tenants.reserve(tenants_.size());
+    for (const auto& [tenant, state] : tenants_) {
+        stats.tenants.push_back({tenant, state.in_flight, state.rejected});
+    }
+    std::sort(stats.tenants.begin(), stats.tenants.end(),
+              [](const TenantStats& a, const TenantStats& b) { return a.in_flight > b.in_flight; });
+    return stats;
+}
+
+}
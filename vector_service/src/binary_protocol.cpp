@@ -0,0 +1,186 @@
+#include "binary_protocol.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+
+namespace vectordb {
+namespace binary {
+
+namespace {
+
+template <typename T>
+T byteswap_if_big(T value) {
+    if constexpr (std::endian::native == std::endian::big) {
+        auto bytes = std::bit_cast<std::array<unsigned char, sizeof(T)>>(value);
+        std::reverse(bytes.begin(), bytes.end());
+        return std::bit_cast<T>(bytes);
+    }
+    return value;
+}
+
+class Reader {
+public:
+    explicit Reader(std::string_view data) : data_(data) {}
+
+    template <typename T>
+    bool read(T& value) {
+        if (remaining() < sizeof(T)) return false;
+        std::memcpy(&value, data_.data() + pos_, sizeof(T));
+        value = byteswap_if_big(value);
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool read_bytes(size_t len, std::string_view& out) {
+        if (remaining() < len) return false;
+        out = data_.substr(pos_, len);
+        pos_ += len;
+        return true;
+    }
+
+    template <typename Len>
+    bool read_string(std::string& out) {
+        Len len;
+        std::string_view bytes;
+        if (!read(len) || !read_bytes(len, bytes)) return false;
+        out.assign(bytes);
+        return true;
+    }
+
+    size_t remaining() const { return data_.size() - pos_; }
+
+private:
+    std::string_view data_;
+    size_t pos_ = 0;
+};
+
+template <typename T>
+void put(std::string& out, T value) {
+    value = byteswap_if_big(value);
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// False, writing nothing, if the string's length doesn't fit in Len.
+template <typename Len>
+bool put_string(std::string& out, const std::string& s) {
+    if (s.size() > std::numeric_limits<Len>::max()) return false;
+    put<Len>(out, static_cast<Len>(s.size()));
+    out.append(s);
+    return true;
+}
+
+}
+
+std::vector<float> Frame::vector(size_t i) const {
+    std::vector<float> values(dimension);
+    std::memcpy(values.data(), vectors.data() + i * dimension * sizeof(float), dimension * sizeof(float));
+    if constexpr (std::endian::native == std::endian::big) {
+        for (auto& v : values) v = byteswap_if_big(v);
+    }
+    return values;
+}
+
+std::string_view peek_collection(std::string_view data) {
+    Reader reader(data);
+    uint32_t magic;
+    uint16_t len;
+    std::string_view collection;
+    if (!reader.read(magic) || magic != MAGIC || !reader.read(len) ||
+        !reader.read_bytes(len, collection)) {
+        return {};
+    }
+    return collection;
+}
+
+std::string decode_request(std::string_view data, bool with_records, Frame& frame) {
+    Reader reader(data);
+
+    uint32_t magic;
+    if (!reader.read(magic) || magic != MAGIC) {
+        return "Bad magic";
+    }
+    if (!reader.read_string<uint16_t>(frame.collection) ||
+        !reader.read(frame.dimension) ||
+        !reader.read(frame.count) ||
+        !reader.read(frame.top_k)) {
+        return "Truncated header";
+    }
+
+    if (frame.dimension == 0) {
+        return "Dimension must be positive";
+    }
+
+    // Count is checked against what was actually sent before anything is
+    // sized from it, so a short frame can't claim billions of vectors.
+    size_t vector_size = static_cast<size_t>(frame.dimension) * sizeof(float);
+    if (frame.count > reader.remaining() / vector_size ||
+        !reader.read_bytes(frame.count * vector_size, frame.vectors)) {
+        return "Truncated vector data";
+    }
+
+    if (!with_records) {
+        return reader.remaining() == 0 ? "" : "Trailing bytes after vectors";
+    }
+
+    // Each record is at least its id length and entry count.
+    if (frame.count > reader.remaining() / (2 * sizeof(uint16_t))) {
+        return "Truncated record";
+    }
+    frame.ids.resize(frame.count);
+    frame.metadata.resize(frame.count);
+    for (uint32_t i = 0; i < frame.count; ++i) {
+        uint16_t entries;
+        if (!reader.read_string<uint16_t>(frame.ids[i]) || !reader.read(entries)) {
+            return "Truncated record";
+        }
+        for (uint16_t e = 0; e < entries; ++e) {
+            std::string key, value;
+            if (!reader.read_string<uint16_t>(key) || !reader.read_string<uint32_t>(value)) {
+                return "Truncated metadata";
+            }
+            frame.metadata[i][std::move(key)] = std::move(value);
+        }
+    }
+
+    return reader.remaining() == 0 ? "" : "Trailing bytes after records";
+}
+
+std::string encode_results(const std::vector<std::vector<HNSWResult>>& results,
+                           float time_ms, bool with_metadata, std::string& out) {
+    out.clear();
+    out.reserve(12 + results.size() * 16);
+
+    put<uint32_t>(out, MAGIC);
+    put<uint32_t>(out, static_cast<uint32_t>(results.size()));
+    put<float>(out, time_ms);
+
+    for (const auto& list : results) {
+        put<uint32_t>(out, static_cast<uint32_t>(list.size()));
+        for (const auto& r : list) {
+            put<float>(out, r.distance);
+            if (!put_string<uint16_t>(out, r.id)) {
+                return "Result id longer than 65535 bytes; use the JSON endpoint";
+            }
+            if (with_metadata && r.data) {
+                if (r.data->metadata.size() > UINT16_MAX) {
+                    return "Too many metadata entries for a binary frame on " + r.id;
+                }
+                put<uint16_t>(out, static_cast<uint16_t>(r.data->metadata.size()));
+                for (const auto& [k, v] : r.data->metadata) {
+                    if (!put_string<uint16_t>(out, k) || !put_string<uint32_t>(out, v)) {
+                        return "Metadata too long for a binary frame on " + r.id;
+                    }
+                }
+            } else {
+                put<uint16_t>(out, 0);
+            }
+        }
+    }
+
+    return "";
+}
+
+}
+}
@@ -0,0 +1,261 @@
+#include "compression.hpp"
+#include <zlib.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace vectordb {
+namespace compression {
+
+namespace {
+
+// Level 1 keeps response compression cheap next to the search it follows;
+// the vector-heavy JSON we send still shrinks 3-4x.
+constexpr int GZIP_LEVEL = 1;
+constexpr int ZSTD_LEVEL = 1;
+constexpr size_t ENCODE_STEP = 16 * 1024;
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) !=
+            std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+class GzipDecoder : public Decoder {
+public:
+    GzipDecoder() {
+        // 16 + MAX_WBITS: gzip framing only.
+        if (inflateInit2(&stream_, 16 + MAX_WBITS) != Z_OK) {
+            throw std::runtime_error("inflateInit2 failed");
+        }
+    }
+    ~GzipDecoder() override { inflateEnd(&stream_); }
+
+    long decode(std::string_view& input, char* dest, size_t capacity) override {
+        if (finished_ || capacity == 0) return 0;
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream_.avail_in = static_cast<uInt>(input.size());
+        stream_.next_out = reinterpret_cast<Bytef*>(dest);
+        stream_.avail_out = static_cast<uInt>(capacity);
+
+        int rc = inflate(&stream_, Z_NO_FLUSH);
+        input.remove_prefix(input.size() - stream_.avail_in);
+        if (rc == Z_STREAM_END) {
+            finished_ = true;
+        } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+            error_ = stream_.msg ? stream_.msg : "invalid gzip data";
+            return -1;
+        }
+        return static_cast<long>(capacity - stream_.avail_out);
+    }
+
+    bool finished() const override { return finished_; }
+
+private:
+    z_stream stream_{};
+    bool finished_ = false;
+};
+
+class GzipEncoder : public Encoder {
+public:
+    GzipEncoder() {
+        if (deflateInit2(&stream_, GZIP_LEVEL, Z_DEFLATED, 16 + MAX_WBITS, 8,
+                         Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("deflateInit2 failed");
+        }
+    }
+    ~GzipEncoder() override { deflateEnd(&stream_); }
+
+    void encode(std::string_view input, std::string& out, Flush flush) override {
+        int mode = flush == Flush::Finish ? Z_FINISH
+                 : flush == Flush::Sync   ? Z_SYNC_FLUSH
+                                          : Z_NO_FLUSH;
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream_.avail_in = static_cast<uInt>(input.size());
+        size_t bound = deflateBound(&stream_, input.size());
+        do {
+            size_t offset = out.size();
+            size_t step = std::max(bound, ENCODE_STEP);
+            out.resize(offset + step);
+            stream_.next_out = reinterpret_cast<Bytef*>(out.data() + offset);
+            stream_.avail_out = static_cast<uInt>(step);
+            deflate(&stream_, mode);
+            out.resize(out.size() - stream_.avail_out);
+        } while (stream_.avail_out == 0);
+    }
+
+private:
+    z_stream stream_{};
+};
+
+#ifdef HAVE_ZSTD
+class ZstdDecoder : public Decoder {
+public:
+    ZstdDecoder() : stream_(ZSTD_createDStream()) {
+        if (!stream_) throw std::runtime_error("ZSTD_createDStream failed");
+    }
+    ~ZstdDecoder() override { ZSTD_freeDStream(stream_); }
+
+    long decode(std::string_view& input, char* dest, size_t capacity) override {
+        if (finished_ || capacity == 0) return 0;
+        ZSTD_inBuffer in{input.data(), input.size(), 0};
+        ZSTD_outBuffer out{dest, capacity, 0};
+        size_t rc = ZSTD_decompressStream(stream_, &out, &in);
+        input.remove_prefix(in.pos);
+        if (ZSTD_isError(rc)) {
+            error_ = ZSTD_getErrorName(rc);
+            return -1;
+        }
+        if (rc == 0) finished_ = true;
+        return static_cast<long>(out.pos);
+    }
+
+    bool finished() const override { return finished_; }
+
+private:
+    ZSTD_DStream* stream_;
+    bool finished_ = false;
+};
+
+class ZstdEncoder : public Encoder {
+public:
+    ZstdEncoder() : ctx_(ZSTD_createCCtx()) {
+        if (!ctx_) throw std::runtime_error("ZSTD_createCCtx failed");
+        ZSTD_CCtx_setParameter(ctx_, ZSTD_c_compressionLevel, ZSTD_LEVEL);
+    }
+    ~ZstdEncoder() override { ZSTD_freeCCtx(ctx_); }
+
+    void encode(std::string_view input, std::string& out, Flush flush) override {
+        ZSTD_EndDirective mode = flush == Flush::Finish ? ZSTD_e_end
+                               : flush == Flush::Sync   ? ZSTD_e_flush
+                                                        : ZSTD_e_continue;
+        ZSTD_inBuffer in{input.data(), input.size(), 0};
+        size_t remaining;
+        do {
+            size_t offset = out.size();
+            size_t step = std::max(ZSTD_compressBound(input.size() - in.pos), ENCODE_STEP);
+            out.resize(offset + step);
+            ZSTD_outBuffer buffer{out.data() + offset, step, 0};
+            remaining = ZSTD_compressStream2(ctx_, &buffer, &in, mode);
+            out.resize(offset + buffer.pos);
+            if (ZSTD_isError(remaining)) {
+                throw std::runtime_error(ZSTD_getErrorName(remaining));
+            }
+        } while (mode == ZSTD_e_continue ? in.pos < in.size : remaining != 0);
+    }
+
+private:
+    ZSTD_CCtx* ctx_;
+};
+#endif
+
+}
+
+const char* name(Encoding encoding) {
+    switch (encoding) {
+        case Encoding::Gzip: return "gzip";
+        case Encoding::Zstd: return "zstd";
+        default: return "identity";
+    }
+}
+
+bool parse_encoding(std::string_view value, Encoding& encoding) {
+    value = trim(value);
+    if (value.empty() || iequals(value, "identity")) {
+        encoding = Encoding::Identity;
+    } else if (iequals(value, "gzip") || iequals(value, "x-gzip")) {
+        encoding = Encoding::Gzip;
+#ifdef HAVE_ZSTD
+    } else if (iequals(value, "zstd")) {
+        encoding = Encoding::Zstd;
+#endif
+    } else {
+        return false;
+    }
+    return true;
+}
+
+Encoding negotiate(std::string_view accept_encoding) {
+    // -1: not listed; otherwise whether the coding is acceptable.
+    int gzip = -1;
+    int zstd = -1;
+    int wildcard = -1;
+    while (!accept_encoding.empty()) {
+        size_t comma = accept_encoding.find(',');
+        std::string_view item = accept_encoding.substr(0, comma);
+        accept_encoding = comma == std::string_view::npos
+            ? std::string_view() : accept_encoding.substr(comma + 1);
+
+        size_t semi = item.find(';');
+        std::string_view coding = trim(item.substr(0, semi));
+        bool acceptable = true;
+        if (semi != std::string_view::npos) {
+            std::string_view param = trim(item.substr(semi + 1));
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+                acceptable = std::strtod(std::string(param.substr(2)).c_str(), nullptr) > 0.0;
+            }
+        }
+
+        if (iequals(coding, "gzip") || iequals(coding, "x-gzip")) {
+            gzip = acceptable;
+        } else if (iequals(coding, "zstd")) {
+            zstd = acceptable;
+        } else if (coding == "*") {
+            wildcard = acceptable;
+        }
+    }
+    if (gzip < 0) gzip = wildcard;
+    if (zstd < 0) zstd = wildcard;
+
+#ifdef HAVE_ZSTD
+    if (zstd > 0) return Encoding::Zstd;
+#endif
+    return gzip > 0 ? Encoding::Gzip : Encoding::Identity;
+}
+
+std::unique_ptr<Decoder> Decoder::create(Encoding encoding) {
+    switch (encoding) {
+        case Encoding::Gzip: return std::make_unique<GzipDecoder>();
+#ifdef HAVE_ZSTD
+        case Encoding::Zstd: return std::make_unique<ZstdDecoder>();
+#endif
+        default: return nullptr;
+    }
+}
+
+std::unique_ptr<Encoder> Encoder::create(Encoding encoding) {
+    switch (encoding) {
+        case Encoding::Gzip: return std::make_unique<GzipEncoder>();
+#ifdef HAVE_ZSTD
+        case Encoding::Zstd: return std::make_unique<ZstdEncoder>();
+#endif
+        default: return nullptr;
+    }
+}
+
+std::string compress(Encoding encoding, std::string_view input) {
+    auto encoder = Encoder::create(encoding);
+    if (!encoder) return std::string(input);
+    std::string out;
+    encoder->encode(input, out, Encoder::Flush::Finish);
+    return out;
+}
+
+}
+}
@@ -1,16 +1,522 @@
 #include "grpc_server.hpp"
+#include "simd_ops.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <deque>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
 
 namespace vectordb {
 
-VectorServiceImpl::VectorServiceImpl(std::shared_ptr<VectorStorage> storage)
+namespace {
+
+// The client's deadline, plus cancellation when it gives up or disconnects.
+Deadline deadline_of(grpc::CallbackServerContext* context) {
+    Deadline deadline = Deadline::at_system_time(context->deadline());
+    deadline.set_cancel_check([context] { return context->IsCancelled(); });
+    return deadline;
+}
+
+grpc::Status deadline_status(const DeadlineExceeded& e) {
+    return grpc::Status(e.cancelled() ? grpc::StatusCode::CANCELLED
+                                      : grpc::StatusCode::DEADLINE_EXCEEDED, e.what());
+}
+
+// A request vector's components. Repeated floats, and packed FLOAT32 data
+// that is float-aligned on a little-endian host, are read in place; other
+// packed encodings are widened into `scratch`, which backs the returned span.
+std::span<const float> vector_values(const google::protobuf::RepeatedField<float>& values,
+                                     const ::vectordb::PackedVector* packed,
+                                     std::vector<float>& scratch)
+{
+    if (!packed) {
+        return {values.data(), static_cast<size_t>(values.size())};
+    }
+
+    const std::string& data = packed->data();
+    size_t width = packed->encoding() == ::vectordb::FLOAT16 ? sizeof(uint16_t)
+                 : packed->encoding() == ::vectordb::INT8 ? sizeof(int8_t)
+                 : sizeof(float);
+    if (data.size() % width != 0) {
+        throw std::runtime_error("Packed vector length is not a multiple of its element size");
+    }
+    size_t dim = data.size() / width;
+
+    switch (packed->encoding()) {
+        case ::vectordb::FLOAT16:
+            scratch.resize(dim);
+            simd::f16_to_f32(reinterpret_cast<const uint16_t*>(data.data()), scratch.data(), dim);
+            return scratch;
+        case ::vectordb::INT8: {
+            float scale = packed->scale() != 0.0f ? packed->scale() : 1.0f / 127.0f;
+            scratch.resize(dim);
+            simd::i8_to_f32(reinterpret_cast<const int8_t*>(data.data()), scale, scratch.data(), dim);
+            return scratch;
+        }
+        default:
+            if (std::endian::native == std::endian::little &&
+                reinterpret_cast<uintptr_t>(data.data()) % alignof(float) == 0) {
+                return {reinterpret_cast<const float*>(data.data()), dim};
+            }
+            scratch.resize(dim);
+            std::memcpy(scratch.data(), data.data(), data.size());
+            if constexpr (std::endian::native == std::endian::big) {
+                for (float& v : scratch) {
+                    v = std::bit_cast<float>(__builtin_bswap32(std::bit_cast<uint32_t>(v)));
+                }
+            }
+            return scratch;
+    }
+}
+
+// What a search copies into each SearchResult besides id and score.
+struct ResultFields {
+    bool values = true;
+    bool metadata = true;
+    // Limits metadata to these keys when not empty.
+    const google::protobuf::RepeatedPtrField<std::string>* metadata_keys = nullptr;
+};
+
+template <typename Request>
+ResultFields result_fields(const Request& request) {
+    ResultFields fields;
+    fields.values = !request.has_include_values() || request.include_values();
+    fields.metadata = !request.has_include_metadata() || request.include_metadata();
+    if (request.metadata_fields_size() > 0) {
+        fields.metadata_keys = &request.metadata_fields();
+    }
+    return fields;
+}
+
+void fill_result(::vectordb::SearchResult* result, const HNSWResult& r, const ResultFields& fields) {
+    result->set_id(r.id);
+    result->set_score(r.distance);
+    if (!r.data) return;
+
+    if (fields.values) {
+        result->mutable_values()->Add(r.values.begin(), r.values.end());
+    }
+    if (!fields.metadata) return;
+
+    auto& metadata = *result->mutable_metadata();
+    if (fields.metadata_keys) {
+        for (const auto& key : *fields.metadata_keys) {
+            auto it = r.data->metadata.find(key);
+            if (it != r.data->metadata.end()) metadata[key] = it->second;
+        }
+    } else {
+        for (const auto& [k, v] : r.data->metadata) {
+            metadata[k] = v;
+        }
+    }
+}
+
+}
+
+VectorServiceImpl::VectorServiceImpl(std::shared_ptr<VectorStorage> storage,
+                                     std::shared_ptr<AdmissionController> admission,
+                                     std::shared_ptr<LatencyMetrics> metrics,
+                                     const GRPCServerConfig& config)
     : storage_(std::move(storage))
+    , admission_(std::move(admission))
+    , metrics_(std::move(metrics))
+    , max_stream_queries_(std::max<size_t>(config.max_stream_queries, 1))
+    , workers_(std::make_unique<ThreadPool>(config.num_workers))
     , start_time_(std::chrono::steady_clock::now())
 {
+    SetMessageAllocatorFor_Insert(&insert_messages_);
+    SetMessageAllocatorFor_BatchInsert(&batch_insert_messages_);
+    SetMessageAllocatorFor_Search(&search_messages_);
+    SetMessageAllocatorFor_BatchSearch(&batch_search_messages_);
+    SetMessageAllocatorFor_GetVector(&get_vector_messages_);
+}
+
+VectorServiceImpl::~VectorServiceImpl() {
+    shutdown();
+}
+
+void VectorServiceImpl::shutdown() {
+    workers_->shutdown();
+}
+
+grpc::Status VectorServiceImpl::admit(std::string_view collection,
+                                      AdmissionController::Ticket& ticket)
+{
+    AdmissionController::Rejection rejection;
+    ticket = admission_->admit(rejection);
+    if (!ticket) {
+        return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Server overloaded");
+    }
+    if (!admission_->admit_tenant(ticket, collection, rejection)) {
+        return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                            "Too many concurrent requests for tenant " +
+                            std::string(tenant_of(collection)));
+    }
+    return grpc::Status::OK;
+}
+
+template <typename Request, typename Response>
+grpc::ServerUnaryReactor* VectorServiceImpl::dispatch(
+    grpc::CallbackServerContext* context, std::string_view endpoint, std::string_view collection,
+    grpc::Status (VectorServiceImpl::*handler)(grpc::CallbackServerContext*, const Request*, Response*),
+    const Request* request, Response* response)
+{
+    auto* reactor = context->DefaultReactor();
+    auto start = LatencyHistogram::clock::now();
+
+    // Rejected calls are answered here, without queueing.
+    AdmissionController::Ticket ticket;
+    if (auto status = admit(collection, ticket); !status.ok()) {
+        reactor->Finish(status);
+        return reactor;
+    }
+
+    // std::function needs a copyable target, so the ticket rides in a shared_ptr.
+    auto shared_ticket = std::make_shared<AdmissionController::Ticket>(std::move(ticket));
+    workers_->submit([this, reactor, context, endpoint, collection, start, handler, request, response,
+                      ticket = std::move(shared_ticket)]() {
+        grpc::Status status;
+        try {
+            status = (this->*handler)(context, request, response);
+        } catch (const std::exception& e) {
+            status = grpc::Status(grpc::StatusCode::INTERNAL, e.what());
+        }
+        // Release admission before the reply goes out, so a client that
+        // immediately sends its next call isn't counted twice.
+        *ticket = AdmissionController::Ticket();
+        metrics_->record(collection, endpoint, LatencyHistogram::clock::now() - start);
+        reactor->Finish(status);
+    });
+    return reactor;
 }
 
-grpc::Status VectorServiceImpl::CreateCollection(
-    grpc::ServerContext*,
+grpc::ServerUnaryReactor* VectorServiceImpl::CreateCollection(
+    grpc::CallbackServerContext* context,
+    const ::vectordb::CreateCollectionRequest* request,
+    ::vectordb::CreateCollectionResponse* response)
+{
+    return dispatch(context, "CreateCollection", request->name(), &VectorServiceImpl::create_collection, request, response);
+}
+
+grpc::ServerUnaryReactor* VectorServiceImpl::DeleteCollection(
+    grpc::CallbackServerContext* context,
+    const ::vectordb::DeleteCollectionRequest* request,
+    ::vectordb::DeleteCollectionResponse* response)
+{
+    return dispatch(context, "DeleteCollection", request->name(), &VectorServiceImpl::delete_collection, request, response);
+}
+
+grpc::ServerUnaryReactor* VectorServiceImpl::ListCollections(
+    grpc::CallbackServerContext* context,
+    const ::vectordb::ListCollectionsRequest* request,
+    ::vectordb::ListCollectionsResponse* response)
+{
+    return dispatch(context, "ListCollections", "", &VectorServiceImpl::list_collections, request, response);
+}
+
+grpc::ServerUnaryReactor* VectorServiceImpl::Insert(
+    grpc::CallbackServerContext* context,
+    const ::vectordb::InsertRequest* request,
+    ::vectordb::InsertResponse* response)
+{
+    return dispatch(context, "Insert", request->collection(), &VectorServiceImpl::insert, request, response);
+}
+
+grpc::ServerUnaryReactor* VectorServiceImpl::BatchInsert(
+    grpc::CallbackServerContext* context,
+    const ::vectordb::BatchInsertRequest* request,
+    ::vectordb::BatchInsertResponse* response)
+{
+    return dispatch(context, "BatchInsert", request->collection(), &VectorServiceImpl::batch_insert, request, response);
+}
+
+grpc::ServerUnaryReactor* VectorServiceImpl::Delete(
+    grpc::CallbackServerContext* context,
+    const ::vectordb::DeleteRequest* request,
+    ::vectordb::DeleteResponse* response)
+{
+    return dispatch(context, "Delete", request->collection(), &VectorServiceImpl::remove, request, response);
+}
+
+grpc::ServerUnaryReactor* VectorServiceImpl::Search(
+    grpc::CallbackServerContext* context,
+    const ::vectordb::SearchRequest* request,
+    ::vectordb::SearchResponse* response)
+{
+    return dispatch(context, "Search", request->collection(), &VectorServiceImpl::search, request, response);
+}
+
+grpc::ServerUnaryReactor* VectorServiceImpl::BatchSearch(
+    grpc::CallbackServerContext* context,
+    const ::vectordb::BatchSearchRequest* request,
+    ::vectordb::BatchSearchResponse* response)
+{
+    return dispatch(context, "BatchSearch", request->collection(), &VectorServiceImpl::batch_search, request, response);
+}
+
+grpc::ServerUnaryReactor* VectorServiceImpl::GetVector(
+    grpc::CallbackServerContext* context,
+    const ::vectordb::GetVectorRequest* request,
+    ::vectordb::GetVectorResponse* response)
+{
+    return dispatch(context, "GetVector", request->collection(), &VectorServiceImpl::get_vector, request, response);
+}
+
+grpc::ServerUnaryReactor* VectorServiceImpl::Stats(
+    grpc::CallbackServerContext* context,
+    const ::vectordb::StatsRequest* request,
+    ::vectordb::StatsResponse* response)
+{
+    return dispatch(context, "Stats", request->collection(), &VectorServiceImpl::stats, request, response);
+}
+
+grpc::ServerUnaryReactor* VectorServiceImpl::Health(
+    grpc::CallbackServerContext* context,
+    const ::vectordb::HealthRequest* request,
+    ::vectordb::HealthResponse* response)
+{
+    // Answered on the gRPC thread, bypassing admission, so health checks
+    // stay responsive under load.
+    auto* reactor = context->DefaultReactor();
+    reactor->Finish(health(context, request, response));
+    return reactor;
+}
+
+// Indexes a StreamInsert call chunk by chunk. The next chunk is read only
+// once the last one is in, so a client sending faster than we index is held
+// back by flow control instead of piling up in memory.
+class VectorServiceImpl::InsertStream final
+    : public grpc::ServerReadReactor<::vectordb::BatchInsertRequest> {
+public:
+    InsertStream(VectorServiceImpl& service, grpc::CallbackServerContext* context,
+                 ::vectordb::StreamInsertResponse* response)
+        : service_(service), context_(context), response_(response)
+    {
+        StartRead(&chunk_);
+    }
+
+    void OnReadDone(bool ok) override {
+        if (!ok) {
+            // The client is done sending (or gone, in which case the reply
+            // goes nowhere).
+            response_->set_success(true);
+            response_->set_inserted_count(inserted_);
+            response_->set_chunks(chunks_);
+            Finish(grpc::Status::OK);
+            return;
+        }
+        service_.workers_->submit([this] { index_chunk(); });
+    }
+
+    void OnDone() override { delete this; }
+
+private:
+    void index_chunk() {
+        if (!chunk_.collection().empty()) {
+            collection_ = chunk_.collection();
+        } else if (collection_.empty()) {
+            Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                "The first chunk must name a collection"));
+            return;
+        } else {
+            chunk_.set_collection(collection_);
+        }
+
+        grpc::Status status;
+        {
+            AdmissionController::Ticket ticket;
+            status = service_.admit(collection_, ticket);
+            if (status.ok()) {
+                auto start = LatencyHistogram::clock::now();
+                ::vectordb::BatchInsertResponse result;
+                status = service_.batch_insert(context_, &chunk_, &result);
+                inserted_ += result.inserted_count();
+                service_.metrics_->record(collection_, "StreamInsert", LatencyHistogram::clock::now() - start);
+            }
+        }
+        if (!status.ok()) {
+            // Earlier chunks stay indexed; say how far the stream got.
+            Finish(grpc::Status(status.error_code(),
+                                "Chunk " + std::to_string(chunks_ + 1) + ": " + status.error_message() +
+                                " (" + std::to_string(inserted_) + " vectors inserted before it)"));
+            return;
+        }
+
+        ++chunks_;
+        chunk_.Clear();
+        StartRead(&chunk_);
+    }
+
+    VectorServiceImpl& service_;
+    grpc::CallbackServerContext* context_;
+    ::vectordb::StreamInsertResponse* response_;
+    ::vectordb::BatchInsertRequest chunk_;
+    std::string collection_;
+    uint64_t inserted_ = 0;
+    uint32_t chunks_ = 0;
+};
+
+// Runs a StreamSearch call's queries on the workers as they are read and
+// writes each result as soon as it is ready. gRPC allows one write at a
+// time, so results finishing together wait in a queue.
+//
+// At most max_stream_queries_ queries are between being read and having
+// their result written; at the limit reading pauses, which bounds both the
+// work queued and the results waiting on a slow reader.
+class VectorServiceImpl::SearchStream final
+    : public grpc::ServerBidiReactor<::vectordb::StreamSearchRequest, ::vectordb::StreamSearchResponse> {
+public:
+    SearchStream(VectorServiceImpl& service, grpc::CallbackServerContext* context)
+        : service_(service), context_(context)
+    {
+        StartRead(&request_);
+    }
+
+    void OnReadDone(bool ok) override {
+        if (!ok) {
+            bool finish;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                reading_ = false;
+                finish = ready_to_finish();
+            }
+            if (finish) Finish(grpc::Status::OK);
+            return;
+        }
+
+        // std::function needs a copyable target, so the query is shared.
+        auto query = std::make_shared<::vectordb::StreamSearchRequest>(std::move(request_));
+        bool read_more;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++outstanding_;
+            paused_ = outstanding_ >= service_.max_stream_queries_;
+            read_more = !paused_;
+        }
+        auto received = LatencyHistogram::clock::now();
+        service_.workers_->submit([this, query, received] { run(*query, received); });
+        if (read_more) StartRead(&request_);
+    }
+
+    void OnWriteDone(bool ok) override {
+        bool write_next = false;
+        bool read_more = false;
+        bool finish;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --outstanding_;
+            if (!ok) {
+                // The client is gone; drop what it will never read.
+                failed_ = true;
+                outstanding_ -= results_.size();
+                results_.clear();
+                writing_ = false;
+            } else if (!results_.empty()) {
+                writing_result_ = std::move(results_.front());
+                results_.pop_front();
+                write_next = true;
+            } else {
+                writing_ = false;
+            }
+            read_more = resume_reading();
+            finish = ready_to_finish();
+        }
+        if (write_next) StartWrite(&writing_result_);
+        if (read_more) StartRead(&request_);
+        if (finish) Finish(grpc::Status::OK);
+    }
+
+    void OnDone() override { delete this; }
+
+private:
+    // Each query is timed from being read to its result being ready.
+    void run(const ::vectordb::StreamSearchRequest& query, LatencyHistogram::clock::time_point received) {
+        ::vectordb::StreamSearchResponse result;
+        result.set_request_id(query.request_id());
+
+        grpc::Status status;
+        {
+            AdmissionController::Ticket ticket;
+            status = service_.admit(query.search().collection(), ticket);
+            if (status.ok()) {
+                status = service_.search(context_, &query.search(), result.mutable_response());
+                service_.metrics_->record(query.search().collection(), "StreamSearch",
+                                          LatencyHistogram::clock::now() - received);
+            }
+        }
+        if (!status.ok()) {
+            result.clear_response();
+            result.set_status_code(status.error_code());
+            result.set_error_message(status.error_message());
+        }
+
+        bool write_now = false;
+        bool read_more = false;
+        bool finish = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (failed_) {
+                --outstanding_;
+                read_more = resume_reading();
+                finish = ready_to_finish();
+            } else if (writing_) {
+                results_.push_back(std::move(result));
+            } else {
+                writing_ = true;
+                writing_result_ = std::move(result);
+                write_now = true;
+            }
+        }
+        if (write_now) StartWrite(&writing_result_);
+        if (read_more) StartRead(&request_);
+        if (finish) Finish(grpc::Status::OK);
+    }
+
+    // Both called with mutex_ held.
+    bool resume_reading() {
+        if (!paused_ || outstanding_ >= service_.max_stream_queries_) return false;
+        paused_ = false;
+        return true;
+    }
+
+    bool ready_to_finish() {
+        if (finished_ || reading_ || writing_ || outstanding_ > 0) return false;
+        finished_ = true;
+        return true;
+    }
+
+    VectorServiceImpl& service_;
+    grpc::CallbackServerContext* context_;
+    ::vectordb::StreamSearchRequest request_;
+
+    std::mutex mutex_;
+    ::vectordb::StreamSearchResponse writing_result_;
+    std::deque<::vectordb::StreamSearchResponse> results_;
+    size_t outstanding_ = 0;
+    bool reading_ = true;
+    bool paused_ = false;
+    bool writing_ = false;
+    bool failed_ = false;
+    bool finished_ = false;
+};
+
+grpc::ServerReadReactor<::vectordb::BatchInsertRequest>* VectorServiceImpl::StreamInsert(
+    grpc::CallbackServerContext* context,
+    ::vectordb::StreamInsertResponse* response)
+{
+    return new InsertStream(*this, context, response);
+}
+
+grpc::ServerBidiReactor<::vectordb::StreamSearchRequest, ::vectordb::StreamSearchResponse>*
+VectorServiceImpl::StreamSearch(grpc::CallbackServerContext* context)
+{
+    return new SearchStream(*this, context);
+}
+
+grpc::Status VectorServiceImpl::create_collection(
+    grpc::CallbackServerContext*,
     const ::vectordb::CreateCollectionRequest* request,
     ::vectordb::CreateCollectionResponse* response)
 {
@@ -40,8 +546,8 @@ grpc::Status VectorServiceImpl::CreateCollection(
     return grpc::Status::OK;
 }
 
-grpc::Status VectorServiceImpl::DeleteCollection(
-    grpc::ServerContext*,
+grpc::Status VectorServiceImpl::delete_collection(
+    grpc::CallbackServerContext*,
     const ::vectordb::DeleteCollectionRequest* request,
     ::vectordb::DeleteCollectionResponse* response)
 {
@@ -52,8 +558,8 @@ grpc::Status VectorServiceImpl::DeleteCollection(
     return grpc::Status::OK;
 }
 
-grpc::Status VectorServiceImpl::ListCollections(
-    grpc::ServerContext*,
+grpc::Status VectorServiceImpl::list_collections(
+    grpc::CallbackServerContext*,
     const ::vectordb::ListCollectionsRequest*,
     ::vectordb::ListCollectionsResponse* response)
 {
@@ -73,14 +579,15 @@ grpc::Status VectorServiceImpl::ListCollections(
     return grpc::Status::OK;
 }
 
-grpc::Status VectorServiceImpl::Insert(
-    grpc::ServerContext*,
+grpc::Status VectorServiceImpl::insert(
+    grpc::CallbackServerContext*,
     const ::vectordb::InsertRequest* request,
     ::vectordb::InsertResponse* response)
 {
     try {
         const auto& vec = request->vector();
-        std::vector<float> values(vec.values().begin(), vec.values().end());
+        std::vector<float> scratch;
+        auto values = vector_values(vec.values(), vec.has_packed() ? &vec.packed() : nullptr, scratch);
 
         std::unordered_map<std::string, std::string> metadata;
         for (const auto& [k, v] : vec.metadata()) {
@@ -105,23 +612,25 @@ grpc::Status VectorServiceImpl::Insert(
     return grpc::Status::OK;
 }
 
-grpc::Status VectorServiceImpl::BatchInsert(
-    grpc::ServerContext*,
+grpc::Status VectorServiceImpl::batch_insert(
+    grpc::CallbackServerContext*,
     const ::vectordb::BatchInsertRequest* request,
     ::vectordb::BatchInsertResponse* response)
 {
     try {
-        std::vector<VectorData> vectors;
-        vectors.reserve(request->vectors_size());
-
-        for (const auto& v : request->vectors()) {
-            VectorData data;
-            data.id = v.id();
-            data.values = std::vector<float>(v.values().begin(), v.values().end());
+        // Values are indexed straight from the request; only packed
+        // FLOAT16/INT8 vectors are widened into a buffer first.
+        std::vector<VectorRef> vectors(request->vectors_size());
+        std::vector<std::vector<float>> scratch(request->vectors_size());
+
+        for (int i = 0; i < request->vectors_size(); ++i) {
+            const auto& v = request->vectors(i);
+            VectorRef& ref = vectors[i];
+            ref.id = v.id();
+            ref.values = vector_values(v.values(), v.has_packed() ? &v.packed() : nullptr, scratch[i]);
             for (const auto& [k, val] : v.metadata()) {
-                data.metadata[k] = val;
+                ref.metadata[k] = val;
             }
-            vectors.push_back(std::move(data));
         }
 
         size_t count = storage_->batch_insert(request->collection(), vectors);
@@ -136,8 +645,8 @@ grpc::Status VectorServiceImpl::BatchInsert(
     return grpc::Status::OK;
 }
 
-grpc::Status VectorServiceImpl::Delete(
-    grpc::ServerContext*,
+grpc::Status VectorServiceImpl::remove(
+    grpc::CallbackServerContext*,
     const ::vectordb::DeleteRequest* request,
     ::vectordb::DeleteResponse* response)
 {
@@ -146,43 +655,41 @@ grpc::Status VectorServiceImpl::Delete(
     return grpc::Status::OK;
 }
 
-grpc::Status VectorServiceImpl::Search(
-    grpc::ServerContext*,
+grpc::Status VectorServiceImpl::search(
+    grpc::CallbackServerContext* context,
     const ::vectordb::SearchRequest* request,
     ::vectordb::SearchResponse* response)
 {
     try {
         auto start = std::chrono::high_resolution_clock::now();
 
-        std::vector<float> query(request->query().begin(), request->query().end());
+        std::vector<float> scratch;
+        auto query = vector_values(request->query(),
+                                   request->has_packed_query() ? &request->packed_query() : nullptr,
+                                   scratch);
+        MetadataFilter filter(request->filter().begin(), request->filter().end());
+        ResultFields fields = result_fields(*request);
         auto results = storage_->search(
             request->collection(),
             query,
-            request->top_k()
+            request->top_k(),
+            0,
+            deadline_of(context),
+            filter,
+            fields.values
         );
 
         auto end = std::chrono::high_resolution_clock::now();
         float time_ms = std::chrono::duration<float, std::milli>(end - start).count();
 
         for (const auto& r : results) {
-            auto* result = response->add_results();
-            result->set_id(r.id);
-            result->set_score(r.distance);
-
-            if (r.data) {
-                for (float v : r.data->values) {
-                    result->add_values(v);
-                }
-                for (const auto& [k, v] : r.data->metadata) {
-                    (*result->mutable_metadata())[k] = v;
-                }
-            }
+            fill_result(response->add_results(), r, fields);
         }
 
         response->set_search_time_ms(time_ms);
-        total_searches_.fetch_add(1);
-        total_search_time_.store(total_search_time_.load() + time_ms);
 
+    } catch (const DeadlineExceeded& e) {
+        return deadline_status(e);
     } catch (const std::exception& e) {
         return grpc::Status(grpc::StatusCode::INTERNAL, e.what());
     }
@@ -190,8 +697,8 @@ grpc::Status VectorServiceImpl::Search(
     return grpc::Status::OK;
 }
 
-grpc::Status VectorServiceImpl::BatchSearch(
-    grpc::ServerContext*,
+grpc::Status VectorServiceImpl::batch_search(
+    grpc::CallbackServerContext* context,
     const ::vectordb::BatchSearchRequest* request,
     ::vectordb::BatchSearchResponse* response)
 {
@@ -200,15 +707,21 @@ grpc::Status VectorServiceImpl::BatchSearch(
 
         std::vector<std::vector<float>> queries;
         queries.reserve(request->queries_size());
+        std::vector<float> scratch;
 
         for (const auto& q : request->queries()) {
-            queries.emplace_back(q.values().begin(), q.values().end());
+            auto values = vector_values(q.values(), q.has_packed() ? &q.packed() : nullptr, scratch);
+            queries.emplace_back(values.begin(), values.end());
         }
 
+        ResultFields fields = result_fields(*request);
         auto all_results = storage_->batch_search(
             request->collection(),
             queries,
-            request->top_k()
+            request->top_k(),
+            0,
+            deadline_of(context),
+            fields.values
         );
 
         auto end = std::chrono::high_resolution_clock::now();
@@ -218,23 +731,14 @@ grpc::Status VectorServiceImpl::BatchSearch(
             auto* result_list = response->add_results();
 
             for (const auto& r : results) {
-                auto* result = result_list->add_results();
-                result->set_id(r.id);
-                result->set_score(r.distance);
-
-                if (r.data) {
-                    for (float v : r.data->values) {
-                        result->add_values(v);
-                    }
-                    for (const auto& [k, v] : r.data->metadata) {
-                        (*result->mutable_metadata())[k] = v;
-                    }
-                }
+                fill_result(result_list->add_results(), r, fields);
             }
         }
 
         response->set_total_time_ms(time_ms);
 
+    } catch (const DeadlineExceeded& e) {
+        return deadline_status(e);
     } catch (const std::exception& e) {
         return grpc::Status(grpc::StatusCode::INTERNAL, e.what());
     }
@@ -242,20 +746,19 @@ grpc::Status VectorServiceImpl::BatchSearch(
     return grpc::Status::OK;
 }
 
-grpc::Status VectorServiceImpl::GetVector(
-    grpc::ServerContext*,
+grpc::Status VectorServiceImpl::get_vector(
+    grpc::CallbackServerContext*,
     const ::vectordb::GetVectorRequest* request,
     ::vectordb::GetVectorResponse* response)
 {
     const VectorData* data = storage_->get(request->collection(), request->id());
+    std::vector<float> values;
 
-    if (data) {
+    if (data && storage_->get_values(request->collection(), request->id(), values)) {
         response->set_found(true);
         auto* vec = response->mutable_vector();
         vec->set_id(data->id);
-        for (float v : data->values) {
-            vec->add_values(v);
-        }
+        vec->mutable_values()->Add(values.begin(), values.end());
         for (const auto& [k, v] : data->metadata) {
             (*vec->mutable_metadata())[k] = v;
         }
@@ -266,8 +769,8 @@ grpc::Status VectorServiceImpl::GetVector(
     return grpc::Status::OK;
 }
 
-grpc::Status VectorServiceImpl::Health(
-    grpc::ServerContext*,
+grpc::Status VectorServiceImpl::health(
+    grpc::CallbackServerContext*,
     const ::vectordb::HealthRequest*,
     ::vectordb::HealthResponse* response)
 {
@@ -281,8 +784,8 @@ grpc::Status VectorServiceImpl::Health(
     return grpc::Status::OK;
 }
 
-grpc::Status VectorServiceImpl::Stats(
-    grpc::ServerContext*,
+grpc::Status VectorServiceImpl::stats(
+    grpc::CallbackServerContext*,
     const ::vectordb::StatsRequest* request,
     ::vectordb::StatsResponse* response)
 {
@@ -293,37 +796,75 @@ grpc::Status VectorServiceImpl::Stats(
         response->set_memory_usage_bytes(stats->memory_usage);
         response->set_index_size_bytes(stats->memory_usage);
 
-        uint64_t searches = total_searches_.load();
-        if (searches > 0) {
-            response->set_avg_search_time_ms(total_search_time_.load() / searches);
+
+        for (const auto& entry : metrics_->snapshot(request->collection())) {
+            const auto& latency = entry.latency;
+            if (entry.endpoint == "Search") {
+                response->set_avg_search_time_ms(latency.mean_ms);
+            }
+            auto* out = response->add_latencies();
+            out->set_endpoint(entry.endpoint);
+            out->set_count(latency.count);
+            out->set_mean_ms(latency.mean_ms);
+            out->set_p50_ms(latency.p50_ms);
+            out->set_p95_ms(latency.p95_ms);
+            out->set_p99_ms(latency.p99_ms);
+            out->set_p999_ms(latency.p999_ms);
+            out->set_max_ms(latency.max_ms);
         }
     }
 
     return grpc::Status::OK;
 }
 
-GRPCServer::GRPCServer(const std::string& address, std::shared_ptr<VectorStorage> storage)
-    : address_(address)
-    , service_(std::make_unique<VectorServiceImpl>(std::move(storage)))
+GRPCServer::GRPCServer(const std::string& address, std::shared_ptr<VectorStorage> storage,
+                       std::shared_ptr<AdmissionController> admission,
+                       const GRPCServerConfig& config,
+                       std::shared_ptr<LatencyMetrics> metrics)
+    : config_(config)
+    , addresses_{address}
 {
+    if (!admission) admission = std::make_shared<AdmissionController>();
+    if (!metrics) metrics = std::make_shared<LatencyMetrics>();
+    service_ = std::make_unique<VectorServiceImpl>(std::move(storage), std::move(admission),
+                                                   std::move(metrics), config_);
 }
 
 GRPCServer::~GRPCServer() {
     shutdown();
 }
 
+void GRPCServer::add_listening_address(const std::string& address) {
+    addresses_.push_back(address);
+}
+
 void GRPCServer::run() {
     grpc::ServerBuilder builder;
 
-    builder.AddListeningPort(address_, grpc::InsecureServerCredentials());
+    for (const auto& address : addresses_) {
+        builder.AddListeningPort(address, grpc::InsecureServerCredentials());
+    }
     builder.RegisterService(service_.get());
 
-    builder.SetMaxReceiveMessageSize(100 * 1024 * 1024);
-    builder.SetMaxSendMessageSize(100 * 1024 * 1024);
+    builder.SetMaxReceiveMessageSize(static_cast<int>(config_.max_message_bytes));
+    builder.SetMaxSendMessageSize(static_cast<int>(config_.max_message_bytes));
+
+    // Backpressure: with the memory quota used up, gRPC stops reading new
+    // messages off the wire rather than buffering without bound.
+    grpc::ResourceQuota quota("vector_service");
+    if (config_.memory_quota_bytes > 0) quota.Resize(config_.memory_quota_bytes);
+    if (config_.max_grpc_threads > 0) quota.SetMaxThreads(config_.max_grpc_threads);
+    builder.SetResourceQuota(quota);
 
     server_ = builder.BuildAndStart();
+    if (!server_) {
+        throw std::runtime_error("Failed to start gRPC server");
+    }
 
-    std::cout << "Vector Service listening on " << address_ << std::endl;
+    for (const auto& address : addresses_) {
+        std::cout << "Vector Service listening on " << address << " ("
+                  << config_.num_workers << " workers)" << std::endl;
+    }
     server_->Wait();
 }
 
@@ -331,6 +872,7 @@ void GRPCServer::shutdown() {
     if (server_) {
         server_->Shutdown();
     }
+    service_->shutdown();
 }
 
 }
@@ -59,7 +59,7 @@ std::string HNSWIndex::generate_id() {
 }
 
 std::string HNSWIndex::insert(
-    const std::vector<float>& vector,
+    std::span<const float> vector,
     const std::string& id,
     const std::unordered_map<std::string, std::string>& metadata)
 {
@@ -67,31 +67,86 @@ std::string HNSWIndex::insert(
         throw std::runtime_error("Vector dimension mismatch");
     }
 
-    std::unique_lock lock(mutex_);
+    std::shared_lock writing(write_mutex_);
+
+    // Claim the id first, so a concurrent insert of the same id fails. Until
+    // the vector is in the graph no search can return it.
+    std::string actual_id;
+    key_t key;
+    {
+        std::unique_lock lock(mutex_);
 
-    std::string actual_id = id.empty() ? generate_id() : id;
+        actual_id = id.empty() ? generate_id() : id;
+        if (id_to_key_.count(actual_id)) {
+            throw std::runtime_error("ID already exists: " + actual_id);
+        }
 
-    if (id_to_key_.count(actual_id)) {
-        throw std::runtime_error("ID already exists: " + actual_id);
+        key = next_key_++;
+        VectorData data;
+        data.id = actual_id;
+        data.metadata = metadata;
+        data_[key] = std::move(data);
+        id_to_key_[actual_id] = key;
+        num_elements_++;
     }
 
-    key_t key = next_key_++;
+    if (!add_to_graph(key, vector.data())) {
+        std::unique_lock lock(mutex_);
+        if (data_.erase(key)) {
+            id_to_key_.erase(actual_id);
+            num_elements_--;
+        }
+        throw std::runtime_error("Failed to add vector to index: " + actual_id);
+    }
 
-    index_->add(key, vector.data());
+    // Removed while being linked in; don't leave it in the graph.
+    bool removed;
+    {
+        std::shared_lock lock(mutex_);
+        removed = !data_.contains(key);
+    }
+    if (removed) {
+        std::shared_lock graph(graph_mutex_);
+        index_->remove(key);
+    }
+    return actual_id;
+}
 
-    VectorData data;
-    data.id = actual_id;
-    data.values = vector;
-    data.metadata = metadata;
+bool HNSWIndex::add_to_graph(key_t key, const float* vector) {
+    for (;;) {
+        size_t capacity;
+        {
+            std::shared_lock graph(graph_mutex_);
+            if (index_->size() < index_->capacity() && index_->add(key, vector)) {
+                return true;
+            }
+            // Another insert may have taken the last slot between the check and the add.
+            capacity = index_->capacity();
+            if (index_->size() < capacity) {
+                return false;
+            }
+        }
 
-    data_[key] = std::move(data);
-    id_to_key_[actual_id] = key;
+        // Growing reallocates the graph, so it waits for every reader to leave.
+        std::unique_lock graph(graph_mutex_);
+        if (index_->capacity() == capacity) {
+            index_->reserve(std::max<size_t>(capacity * 2, 1024));
+        }
+    }
+}
 
-    num_elements_++;
-    return actual_id;
+size_t HNSWIndex::batch_insert(const std::vector<VectorRecord>& vectors) {
+    size_t count = 0;
+    for (const auto& v : vectors) {
+        try {
+            insert(v.values, v.id, v.metadata);
+            count++;
+        } catch (...) {}
+    }
+    return count;
 }
 
-size_t HNSWIndex::batch_insert(const std::vector<VectorData>& vectors) {
+size_t HNSWIndex::batch_insert(std::span<const VectorRef> vectors) {
     size_t count = 0;
     for (const auto& v : vectors) {
         try {
@@ -103,34 +158,51 @@ size_t HNSWIndex::batch_insert(const std::vector<VectorData>& vectors) {
 }
 
 bool HNSWIndex::remove(const std::string& id) {
-    std::unique_lock lock(mutex_);
+    std::shared_lock writing(write_mutex_);
 
-    auto it = id_to_key_.find(id);
-    if (it == id_to_key_.end()) {
-        return false;
-    }
+    key_t key;
+    {
+        std::unique_lock lock(mutex_);
 
-    key_t key = it->second;
+        auto it = id_to_key_.find(id);
+        if (it == id_to_key_.end()) {
+            return false;
+        }
 
-    index_->remove(key);
+        key = it->second;
+        data_.erase(key);
+        id_to_key_.erase(it);
+        num_elements_--;
+    }
 
-    data_.erase(key);
-    id_to_key_.erase(it);
+    // Searches drop keys without data, so the vector is already gone for them.
+    std::shared_lock graph(graph_mutex_);
+    index_->remove(key);
+    return true;
+}
 
-    num_elements_--;
+bool matches_filter(const VectorData& data, const MetadataFilter& filter) {
+    for (const auto& [key, value] : filter) {
+        auto it = data.metadata.find(key);
+        if (it == data.metadata.end() || it->second != value) {
+            return false;
+        }
+    }
     return true;
 }
 
 std::vector<HNSWResult> HNSWIndex::search(
-    const std::vector<float>& query,
+    std::span<const float> query,
     size_t k,
-    size_t ef) const
+    size_t ef,
+    const Deadline& deadline,
+    const MetadataFilter& filter,
+    bool include_values) const
 {
     if (query.size() != dimension_) {
         throw std::runtime_error("Query dimension mismatch");
     }
-
-    std::shared_lock lock(mutex_);
+    deadline.check();
 
     if (num_elements_ == 0) {
         return {};
@@ -138,7 +210,31 @@ std::vector<HNSWResult> HNSWIndex::search(
 
     size_t actual_k = std::min(k, num_elements_.load());
 
-    auto results = index_->search(query.data(), actual_k);
+    std::shared_lock graph(graph_mutex_);
+
+    // An unfiltered walk runs without the id lock, so inserts can register
+    // their ids meanwhile; a filtered one reads metadata as it goes.
+    std::shared_lock lock(mutex_, std::defer_lock);
+    if (!filter.empty()) lock.lock();
+
+    auto matches = [&](key_t key) {
+        auto it = data_.find(key);
+        return it != data_.end() && matches_filter(it->second, filter);
+    };
+
+    auto results = filter.empty()
+        ? index_->search(query.data(), actual_k)
+        : index_->filtered_search(query.data(), actual_k, matches);
+
+    // When matches are rare the walk can exhaust its candidates before
+    // finding k of them. Checking every vector is then the only way to be
+    // sure none were missed.
+    if (!filter.empty() && results.size() < actual_k) {
+        results = index_->filtered_search(query.data(), actual_k, matches,
+                                          index_t::any_thread(), true);
+    }
+
+    if (!lock.owns_lock()) lock.lock();
 
     std::vector<HNSWResult> output;
     output.reserve(results.size());
@@ -153,7 +249,11 @@ std::vector<HNSWResult> HNSWIndex::search(
             r.id = data_it->second.id;
             r.distance = dist;
             r.data = &data_it->second;
-            output.push_back(r);
+            if (include_values) {
+                r.values.resize(dimension_);
+                index_->get(key, r.values.data());
+            }
+            output.push_back(std::move(r));
         }
     }
 
@@ -163,7 +263,9 @@ std::vector<HNSWResult> HNSWIndex::search(
 std::vector<std::vector<HNSWResult>> HNSWIndex::batch_search(
     const std::vector<std::vector<float>>& queries,
     size_t k,
-    size_t ef) const
+    size_t ef,
+    const Deadline& deadline,
+    bool include_values) const
 {
     size_t num_queries = queries.size();
 
@@ -172,7 +274,7 @@ std::vector<std::vector<HNSWResult>> HNSWIndex::batch_search(
         std::vector<std::vector<HNSWResult>> results;
         results.reserve(num_queries);
         for (const auto& q : queries) {
-            results.push_back(search(q, k, ef));
+            results.push_back(search(q, k, ef, deadline, {}, include_values));
         }
         return results;
     }
@@ -199,16 +301,26 @@ std::vector<std::vector<HNSWResult>> HNSWIndex::batch_search(
 
         if (start_idx >= num_queries) break;
 
-        futures.push_back(std::async(std::launch::async, [this, &queries, &results, k, ef, start_idx, end_idx]() {
+        futures.push_back(std::async(std::launch::async, [this, &queries, &results, &deadline, k, ef,
+                                                          include_values, start_idx, end_idx]() {
             for (size_t i = start_idx; i < end_idx; ++i) {
-                results[i] = search(queries[i], k, ef);
+                results[i] = search(queries[i], k, ef, deadline, {}, include_values);
             }
         }));
     }
 
-    // Wait for all threads to complete
+    // Wait for every thread before rethrowing: they share `results`, and an
+    // expired deadline stops each of them at its next query anyway.
+    std::exception_ptr error;
     for (auto& f : futures) {
-        f.get();
+        try {
+            f.get();
+        } catch (...) {
+            if (!error) error = std::current_exception();
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
     }
 
     return results;
@@ -230,7 +342,28 @@ const VectorData* HNSWIndex::get(const std::string& id) const {
     return &data_it->second;
 }
 
+bool HNSWIndex::get_values(const std::string& id, std::vector<float>& values) const {
+    std::shared_lock graph(graph_mutex_);
+    std::shared_lock lock(mutex_);
+
+    values.clear();
+    auto key_it = id_to_key_.find(id);
+    if (key_it == id_to_key_.end()) {
+        return false;
+    }
+
+    values.resize(dimension_);
+    if (index_->get(key_it->second, values.data()) != 1) {
+        values.clear();
+        return false;
+    }
+    return true;
+}
+
 bool HNSWIndex::save(const std::string& path) const {
+    // Searches carry on; inserts and removes wait so both files agree.
+    std::unique_lock writing(write_mutex_);
+    std::shared_lock graph(graph_mutex_);
     std::shared_lock lock(mutex_);
 
     try {
@@ -251,9 +384,10 @@ bool HNSWIndex::save(const std::string& path) const {
             ofs.write(reinterpret_cast<const char*>(&id_len), sizeof(id_len));
             ofs.write(data.id.data(), id_len);
 
-            size_t vec_size = data.values.size();
+            // The values are in the index file. Their length is still
+            // written, as 0, so files stay readable either way.
+            size_t vec_size = 0;
             ofs.write(reinterpret_cast<const char*>(&vec_size), sizeof(vec_size));
-            ofs.write(reinterpret_cast<const char*>(data.values.data()), vec_size * sizeof(float));
 
             size_t meta_size = data.metadata.size();
             ofs.write(reinterpret_cast<const char*>(&meta_size), sizeof(meta_size));
@@ -274,6 +408,8 @@ bool HNSWIndex::save(const std::string& path) const {
 }
 
 bool HNSWIndex::load(const std::string& path) {
+    std::unique_lock writing(write_mutex_);
+    std::unique_lock graph(graph_mutex_);
     std::unique_lock lock(mutex_);
 
     try {
@@ -304,10 +440,10 @@ bool HNSWIndex::load(const std::string& path) {
             data.id.resize(id_len);
             ifs.read(data.id.data(), id_len);
 
+            // Older files carry a second copy of the values; the index's own is used.
             size_t vec_size;
             ifs.read(reinterpret_cast<char*>(&vec_size), sizeof(vec_size));
-            data.values.resize(vec_size);
-            ifs.read(reinterpret_cast<char*>(data.values.data()), vec_size * sizeof(float));
+            ifs.seekg(static_cast<std::streamoff>(vec_size * sizeof(float)), std::ios::cur);
 
             size_t meta_size;
             ifs.read(reinterpret_cast<char*>(&meta_size), sizeof(meta_size));
@@ -334,6 +470,7 @@ bool HNSWIndex::load(const std::string& path) {
 }
 
 size_t HNSWIndex::memory_usage() const {
+    std::shared_lock graph(graph_mutex_);
     std::shared_lock lock(mutex_);
 
     size_t usage = index_->memory_usage();
@@ -341,7 +478,6 @@ size_t HNSWIndex::memory_usage() const {
     for (const auto& [key, data] : data_) {
         usage += sizeof(key);
         usage += data.id.capacity();
-        usage += data.values.capacity() * sizeof(float);
         for (const auto& [k, v] : data.metadata) {
             usage += k.capacity() + v.capacity();
         }
@@ -0,0 +1,215 @@
+#include "http_request.hpp"
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+
+namespace vectordb {
+
+namespace {
+
+bool iequals(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char ca = a[i] >= 'A' && a[i] <= 'Z' ? a[i] + 32 : a[i];
+        char cb = b[i] >= 'A' && b[i] <= 'Z' ? b[i] + 32 : b[i];
+        if (ca != cb) return false;
+    }
+    return true;
+}
+
+std::string trim(const char* begin, const char* end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t')) begin++;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) end--;
+    return std::string(begin, end);
+}
+
+}
+
+void ByteBuffer::reserve(size_t n) {
+    if (n <= capacity_) return;
+    std::unique_ptr<char[]> grown(new char[n]);
+    if (size_ > 0) {
+        std::memcpy(grown.get(), data_.get(), size_);
+    }
+    data_ = std::move(grown);
+    capacity_ = n;
+}
+
+void ByteBuffer::append(const char* bytes, size_t n) {
+    if (size_ + n > capacity_) {
+        reserve(std::max(size_ + n, capacity_ * 2));
+    }
+    std::memcpy(data_.get() + size_, bytes, n);
+    size_ += n;
+}
+
+const std::string* HTTPRequest::header(const std::string& name) const {
+    for (const auto& [k, v] : headers) {
+        if (iequals(k, name)) return &v;
+    }
+    return nullptr;
+}
+
+std::optional<std::string_view> HTTPRequest::query_param(std::string_view name) const {
+    std::string_view target = path;
+    size_t question = target.find('?');
+    if (question == std::string_view::npos) return std::nullopt;
+
+    std::string_view query = target.substr(question + 1);
+    while (!query.empty()) {
+        size_t amp = query.find('&');
+        std::string_view pair = query.substr(0, amp);
+        query = amp == std::string_view::npos ? std::string_view() : query.substr(amp + 1);
+
+        size_t eq = pair.find('=');
+        if (pair.substr(0, eq) == name) {
+            return eq == std::string_view::npos ? std::string_view() : pair.substr(eq + 1);
+        }
+    }
+    return std::nullopt;
+}
+
+bool HTTPRequest::keep_alive() const {
+    const auto* connection = header("Connection");
+    if (version == "HTTP/1.0") {
+        return connection && iequals(*connection, "keep-alive");
+    }
+    return !connection || !iequals(*connection, "close");
+}
+
+const char* status_text(int code) {
+    switch (code) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 409: return "Conflict";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 415: return "Unsupported Media Type";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default: return "Unknown";
+    }
+}
+
+void HTTPRequestParser::reset() {
+    request_ = HTTPRequest{};
+    scanned_ = 0;
+    head_size_ = 0;
+    error_code_ = 0;
+    error_message_.clear();
+}
+
+HTTPRequestParser::Status HTTPRequestParser::fail(int code, const std::string& message) {
+    error_code_ = code;
+    error_message_ = message;
+    return Status::Error;
+}
+
+HTTPRequestParser::Status HTTPRequestParser::parse(const char* data, size_t len) {
+    if (error_code_ != 0) return Status::Error;
+
+    if (head_size_ == 0) {
+        // Resume the terminator search just before where the last call stopped,
+        // so a "\r\n\r\n" split across reads is still found.
+        size_t from = scanned_ >= 3 ? scanned_ - 3 : 0;
+        const char* found = nullptr;
+        if (len > from) {
+            const char* hay = data + from;
+            size_t hay_len = len - from;
+            while (hay_len >= 4) {
+                auto* cr = static_cast<const char*>(std::memchr(hay, '\r', hay_len - 3));
+                if (!cr) break;
+                if (cr[1] == '\n' && cr[2] == '\r' && cr[3] == '\n') {
+                    found = cr;
+                    break;
+                }
+                hay_len -= (cr + 1) - hay;
+                hay = cr + 1;
+            }
+        }
+
+        if (!found) {
+            scanned_ = len;
+            if (len > MAX_HEAD_SIZE) {
+                return fail(431, "Request header fields too large");
+            }
+            return Status::NeedMore;
+        }
+
+        size_t head_len = (found - data) + 4;
+        if (!parse_head(data, head_len)) {
+            return Status::Error;
+        }
+        head_size_ = head_len;
+    }
+
+    if (len < message_size()) {
+        return Status::NeedMore;
+    }
+    return Status::Complete;
+}
+
+bool HTTPRequestParser::parse_head(const char* data, size_t len) {
+    const char* end = data + len - 2;
+    const char* line_end = static_cast<const char*>(std::memchr(data, '\r', len));
+
+    const char* sp1 = static_cast<const char*>(std::memchr(data, ' ', line_end - data));
+    const char* sp2 = sp1 ? static_cast<const char*>(std::memchr(sp1 + 1, ' ', line_end - sp1 - 1)) : nullptr;
+    if (!sp1 || !sp2 || sp1 == data || sp2 == sp1 + 1) {
+        fail(400, "Malformed request line");
+        return false;
+    }
+
+    request_.method.assign(data, sp1);
+    request_.path.assign(sp1 + 1, sp2);
+    request_.version.assign(sp2 + 1, line_end);
+
+    const char* pos = line_end + 2;
+    while (pos < end) {
+        const char* eol = static_cast<const char*>(std::memchr(pos, '\r', end - pos));
+        if (!eol) eol = end;
+        const char* colon = static_cast<const char*>(std::memchr(pos, ':', eol - pos));
+        if (!colon || colon == pos) {
+            fail(400, "Malformed header line");
+            return false;
+        }
+        request_.headers.emplace_back(std::string(pos, colon), trim(colon + 1, eol));
+        pos = eol + 2;
+    }
+
+    if (const auto* te = request_.header("Transfer-Encoding")) {
+        if (!iequals(*te, "identity")) {
+            fail(501, "Transfer-Encoding not supported");
+            return false;
+        }
+    }
+
+    if (const auto* cl = request_.header("Content-Length")) {
+        size_t value = 0;
+        auto [ptr, ec] = std::from_chars(cl->data(), cl->data() + cl->size(), value);
+        if (ec != std::errc() || ptr != cl->data() + cl->size()) {
+            fail(400, "Invalid Content-Length");
+            return false;
+        }
+        // message_size() adds the head to this; it must not wrap.
+        if (value > SIZE_MAX - len) {
+            fail(413, "Content-Length too large");
+            return false;
+        }
+        request_.content_length = value;
+    }
+
+    return true;
+}
+
+}
@@ -1,85 +1,144 @@
 #include "http_router.hpp"
+#include <stdexcept>
 
 namespace vectordb {
 
-void HTTPRouter::add_route(const std::string& method, const std::string& pattern,
-                           std::function<std::string(const std::vector<std::string>&, const std::string&)> handler) {
-    Route route;
-    route.method = method;
-    route.pattern = pattern;
-    auto [regex, param_names] = compile_pattern(pattern);
-    route.regex = regex;
-    route.param_names = param_names;
-    route.handler = handler;
-    routes_.push_back(std::move(route));
+HTTPRouter::Node::Node() {
+    routes.fill(NO_ROUTE);
 }
 
-void HTTPRouter::get(const std::string& pattern,
-                     std::function<std::string(const std::vector<std::string>&, const std::string&)> handler) {
-    add_route("GET", pattern, handler);
-}
+HTTPRouter::HTTPRouter() : root_(std::make_unique<Node>()) {}
 
-void HTTPRouter::post(const std::string& pattern,
-                      std::function<std::string(const std::vector<std::string>&, const std::string&)> handler) {
-    add_route("POST", pattern, handler);
-}
+HTTPRouter::~HTTPRouter() = default;
 
-void HTTPRouter::put(const std::string& pattern,
-                     std::function<std::string(const std::vector<std::string>&, const std::string&)> handler) {
-    add_route("PUT", pattern, handler);
+int HTTPRouter::method_index(std::string_view method) {
+    if (method == "GET") return GET;
+    if (method == "POST") return POST;
+    if (method == "PUT") return PUT;
+    if (method == "DELETE") return DELETE;
+    return -1;
 }
 
-void HTTPRouter::del(const std::string& pattern,
-                     std::function<std::string(const std::vector<std::string>&, const std::string&)> handler) {
-    add_route("DELETE", pattern, handler);
+HTTPRouter::Node* HTTPRouter::insert_literal(Node* node, std::string_view text) {
+    while (!text.empty()) {
+        size_t slot = node->first_bytes.find(text[0]);
+        if (slot == std::string::npos) {
+            auto child = std::make_unique<Node>();
+            child->prefix.assign(text);
+            node->first_bytes.push_back(text[0]);
+            node->children.push_back(std::move(child));
+            return node->children.back().get();
+        }
+
+        Node* child = node->children[slot].get();
+        size_t common = 0;
+        while (common < child->prefix.size() && common < text.size() &&
+               child->prefix[common] == text[common]) {
+            ++common;
+        }
+
+        // Split the edge so the shared part becomes its own node.
+        if (common < child->prefix.size()) {
+            auto split = std::make_unique<Node>();
+            split->prefix = child->prefix.substr(0, common);
+            child->prefix.erase(0, common);
+            split->first_bytes.push_back(child->prefix[0]);
+            split->children.push_back(std::move(node->children[slot]));
+            node->children[slot] = std::move(split);
+            child = node->children[slot].get();
+        }
+
+        node = child;
+        text.remove_prefix(common);
+    }
+    return node;
 }
 
-std::pair<std::regex, std::vector<std::string>> HTTPRouter::compile_pattern(const std::string& pattern) {
-    std::vector<std::string> param_names;
-    std::string regex_str = "^";
+void HTTPRouter::add(std::string_view method, std::string_view pattern, uint32_t route_id) {
+    int index = method_index(method);
+    if (index < 0) {
+        throw std::invalid_argument("Unsupported method: " + std::string(method));
+    }
+    if (pattern.empty() || pattern[0] != '/') {
+        throw std::invalid_argument("Route pattern must start with '/': " + std::string(pattern));
+    }
 
-    size_t i = 0;
-    while (i < pattern.length()) {
-        if (pattern[i] == ':') {
-            size_t start = i + 1;
-            while (i + 1 < pattern.length() && pattern[i + 1] != '/') {
-                i++;
-            }
-            std::string param_name = pattern.substr(start, i - start + 1);
-            param_names.push_back(param_name);
-            regex_str += "([^/]+)";
-        } else {
-            if (pattern[i] == '.' || pattern[i] == '*' || pattern[i] == '+' ||
-                pattern[i] == '?' || pattern[i] == '(' || pattern[i] == ')' ||
-                pattern[i] == '[' || pattern[i] == ']' || pattern[i] == '{' ||
-                pattern[i] == '}' || pattern[i] == '|' || pattern[i] == '^' ||
-                pattern[i] == '$' || pattern[i] == '\\') {
-                regex_str += '\\';
-            }
-            regex_str += pattern[i];
+    Node* node = root_.get();
+    size_t params = 0;
+    std::string_view rest = pattern;
+    while (!rest.empty()) {
+        size_t special = rest.find_first_of(":*");
+        node = insert_literal(node, rest.substr(0, special));
+        if (special == std::string_view::npos) break;
+
+        bool catch_all = rest[special] == '*';
+        size_t end = rest.find('/', special);
+        if (end == special + 1 || (catch_all && end != std::string_view::npos) ||
+            special == 0 || rest[special - 1] != '/' || ++params > RouteParams::MAX_PARAMS) {
+            throw std::invalid_argument("Invalid route pattern: " + std::string(pattern));
         }
-        i++;
+
+        auto& next = catch_all ? node->catch_all : node->param;
+        if (!next) next = std::make_unique<Node>();
+        node = next.get();
+        rest = end == std::string_view::npos ? std::string_view() : rest.substr(end);
     }
 
-    regex_str += "$";
-    return {std::regex(regex_str), param_names};
+    if (node->routes[index] != NO_ROUTE) {
+        throw std::invalid_argument("Duplicate route: " + std::string(method) + " " +
+                                    std::string(pattern));
+    }
+    node->routes[index] = route_id;
 }
 
-std::string HTTPRouter::route(const std::string& method, const std::string& path, const std::string& body) {
-    for (const auto& route : routes_) {
-        if (route.method != method) continue;
+bool HTTPRouter::match_node(const Node& node, std::string_view rest, int method,
+                            RouteParams& params, uint32_t& route) const {
+    if (rest.empty()) {
+        route = node.routes[method];
+        return route != NO_ROUTE;
+    }
+
+    size_t slot = node.first_bytes.find(rest[0]);
+    if (slot != std::string::npos) {
+        const Node& child = *node.children[slot];
+        if (rest.starts_with(child.prefix) &&
+            match_node(child, rest.substr(child.prefix.size()), method, params, route)) {
+            return true;
+        }
+    }
 
-        std::smatch match;
-        if (std::regex_match(path, match, route.regex)) {
-            std::vector<std::string> params;
-            for (size_t i = 1; i < match.size(); ++i) {
-                params.push_back(match[i].str());
+    if (node.param) {
+        size_t end = rest.find('/');
+        std::string_view segment = rest.substr(0, end);
+        if (!segment.empty() && params.count_ < RouteParams::MAX_PARAMS) {
+            params.values_[params.count_++] = segment;
+            if (match_node(*node.param, rest.substr(segment.size()), method, params, route)) {
+                return true;
             }
-            return route.handler(params, body);
+            --params.count_;
         }
     }
 
-    return "";
+    if (node.catch_all && params.count_ < RouteParams::MAX_PARAMS) {
+        route = node.catch_all->routes[method];
+        if (route != NO_ROUTE) {
+            params.values_[params.count_++] = rest;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint32_t HTTPRouter::match(std::string_view method, std::string_view path,
+                           RouteParams& params) const {
+    params.count_ = 0;
+    int index = method_index(method);
+    if (index < 0) return NO_ROUTE;
+
+    path = path.substr(0, path.find('?'));
+    uint32_t route = NO_ROUTE;
+    return match_node(*root_, path, index, params, route) ? route : NO_ROUTE;
 }
 
 }
@@ -1,436 +1,1718 @@
 #include "http_server.hpp"
-#include "http_router.hpp"
+#include "admission.hpp"
+#include "http_request.hpp"
+#include "binary_protocol.hpp"
+#include "compression.hpp"
+#include "io_uring.hpp"
+#include "json_number.hpp"
+#include "json_parser.hpp"
+#include "json_writer.hpp"
 #include <iostream>
-#include <sstream>
 #include <cstring>
 #include <cerrno>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <poll.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/un.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
 #include <chrono>
 #include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <deque>
+#include <string_view>
 
 namespace vectordb {
 
 namespace {
 
-std::string parse_json_string(const std::string& json, const std::string& key) {
-    std::string search = "\"" + key + "\"";
-    size_t pos = json.find(search);
-    if (pos == std::string::npos) return "";
-
-    size_t colon = json.find(':', pos);
-    if (colon == std::string::npos) return "";
-
-    size_t start = json.find('"', colon);
-    if (start == std::string::npos) return "";
-
-    size_t end = json.find('"', start + 1);
-    if (end == std::string::npos) return "";
-
-    return json.substr(start + 1, end - start - 1);
+const int SOCKET_BUFFER_SIZE = 16 * 1024 * 1024;
+constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+constexpr size_t LARGE_BODY_LOG_STEP = 50 * 1024 * 1024;
+constexpr auto CLIENT_TIMEOUT = std::chrono::seconds(300);
+
+// A streaming worker pauses once this much of its output is still unsent,
+// so a slow reader holds a bounded amount of memory rather than the whole body.
+constexpr size_t STREAM_HIGH_WATER = 4 * 1024 * 1024;
+constexpr size_t STREAM_LOW_WATER = 1024 * 1024;
+
+// Queries searched together before their results are flushed as one chunk.
+constexpr size_t STREAM_QUERY_BLOCK = 1024;
+
+// Ingest bodies are read this much at a time; a single NDJSON line may not
+// exceed INGEST_MAX_LINE.
+constexpr size_t INGEST_READ_SIZE = 256 * 1024;
+constexpr size_t INGEST_MAX_LINE = 16 * 1024 * 1024;
+
+// Most buffers handed to one sendmsg(); a response is two (head and body),
+// so this covers a deep pipeline.
+constexpr size_t SEND_IOV_MAX = 64;
+
+// io_uring backend: ring size per shard, and how many connections at a time
+// can receive into a registered buffer.
+constexpr unsigned URING_ENTRIES = 1024;
+constexpr unsigned URING_BUFFER_SLOTS = 64;
+
+// Bodies with at least this much left to arrive are read with
+// IORING_OP_READ_FIXED into a registered buffer, so the kernel pins the
+// destination pages once instead of on every read.
+constexpr size_t URING_FIXED_BODY_MIN = 1024 * 1024;
+
+// What a ring completion belongs to, kept in the low bits of its user_data
+// next to the connection pointer (or the listening fd for accepts).
+enum UringOp : uint64_t { URING_ACCEPT, URING_WAKE, URING_RECV, URING_SEND, URING_HANGUP };
+constexpr int URING_OP_BITS = 3;
+constexpr uint64_t URING_OP_MASK = (1 << URING_OP_BITS) - 1;
+
+// A body up to this size gets its whole buffer as soon as the head is
+// parsed. A larger one starts here and doubles as it arrives, so a head
+// claiming a huge Content-Length is not given that memory up front.
+constexpr size_t MAX_BODY_PRESIZE = 4 * 1024 * 1024;
+
+// The receive buffer size to grow to before a read: by a chunk until the
+// head is parsed, then towards the whole message.
+size_t receive_target(const HTTPRequestParser& parser, const ByteBuffer& in) {
+    size_t chunk = in.size() + READ_CHUNK_SIZE;
+    if (!parser.head_complete()) return chunk;
+    size_t presize = std::max(MAX_BODY_PRESIZE, in.size() * 2);
+    return std::max(chunk, std::min(parser.message_size(), presize));
 }
 
-int parse_json_int(const std::string& json, const std::string& key, int default_val = 0) {
-    std::string search = "\"" + key + "\"";
-    size_t pos = json.find(search);
-    if (pos == std::string::npos) return default_val;
-
-    size_t colon = json.find(':', pos);
-    if (colon == std::string::npos) return default_val;
-
-    size_t num_start = colon + 1;
-    while (num_start < json.length() && (json[num_start] == ' ' || json[num_start] == '\t')) {
-        num_start++;
-    }
-
-    size_t num_end = num_start;
-    while (num_end < json.length() && (json[num_end] >= '0' && json[num_end] <= '9')) {
-        num_end++;
-    }
-
-    if (num_end > num_start) {
-        return std::stoi(json.substr(num_start, num_end - num_start));
-    }
-
-    return default_val;
+void make_room(const HTTPRequestParser& parser, ByteBuffer& in) {
+    if (in.available() > 0) return;
+    in.reserve(receive_target(parser, in));
 }
 
-std::vector<float> parse_json_float_array(const std::string& json, const std::string& key) {
-    std::vector<float> result;
-
-    std::string search_key = "\"" + key + "\"";
-    size_t key_pos = json.find(search_key);
-    if (key_pos == std::string::npos) return result;
-
-    size_t bracket_pos = json.find('[', key_pos + search_key.length());
-    if (bracket_pos == std::string::npos) return result;
+// A compressed request body may expand to MAX_DECODE_RATIO times its own
+// size (but always to MIN_DECODED_LIMIT), and never past MAX_DECODED_BODY,
+// so a small decompression bomb can't claim much more memory than sending
+// the same body uncompressed would. JSON vectors compress 3-5x.
+constexpr size_t MAX_DECODE_RATIO = 64;
+constexpr size_t MIN_DECODED_LIMIT = 16 * 1024 * 1024;
+constexpr size_t MAX_DECODED_BODY = 1024ull * 1024 * 1024;
+
+// Responses smaller than this go out as they are; compressing them saves
+// less than it costs.
+constexpr size_t MIN_COMPRESSED_RESPONSE = 1024;
+
+// Decompresses a streamed upload as it is read: the prefix that arrived with
+// the head first, then the rest from the socket.
+class DecodingReader : public BodyReader {
+public:
+    DecodingReader(std::unique_ptr<compression::Decoder> decoder, std::string_view prefix,
+                   std::unique_ptr<BodyReader> source)
+        : decoder_(std::move(decoder)), input_(prefix), source_(std::move(source)) {}
+
+    long read(char* dest, size_t len) override {
+        while (!failed_) {
+            if (decoder_->finished()) {
+                // Trailing bytes after the compressed stream are malformed input.
+                if (input_.empty() && source_remaining() == 0) return 0;
+                failed_ = true;
+                break;
+            }
+            if (!input_.empty()) {
+                long n = decoder_->decode(input_, dest, len);
+                if (n < 0) {
+                    failed_ = true;
+                    break;
+                }
+                if (n > 0) return n;
+                if (decoder_->finished()) continue;
+            }
+            if (source_remaining() == 0) {
+                // The body ended before the compressed stream did.
+                failed_ = true;
+                break;
+            }
+            if (!chunk_) chunk_.reset(new char[INGEST_READ_SIZE]);
+            long n = source_->read(chunk_.get(), INGEST_READ_SIZE);
+            if (n <= 0) {
+                failed_ = true;
+                break;
+            }
+            input_ = std::string_view(chunk_.get(), n);
+        }
+        return -1;
+    }
+
+    // The decoded size isn't known up front, so this counts encoded bytes
+    // not yet decoded; it only reaches zero once the stream has ended.
+    size_t remaining() const override {
+        if (decoder_->finished() || failed_) return source_remaining() + input_.size();
+        return source_remaining() + input_.size() + 1;
+    }
+
+private:
+    size_t source_remaining() const { return source_ ? source_->remaining() : 0; }
+
+    std::unique_ptr<compression::Decoder> decoder_;
+    std::string_view input_;
+    std::unique_ptr<BodyReader> source_;
+    std::unique_ptr<char[]> chunk_;
+    bool failed_ = false;
+};
+
+// Compresses a chunked response. Each write is sync-flushed, so the client
+// can decode every chunk as soon as it arrives.
+class EncodingWriter : public ChunkWriter {
+public:
+    EncodingWriter(std::unique_ptr<compression::Encoder> encoder, ChunkWriter& out)
+        : encoder_(std::move(encoder)), out_(out) {}
+
+    bool write(std::string_view data) override {
+        if (data.empty()) return true;
+        buffer_.clear();
+        encoder_->encode(data, buffer_, compression::Encoder::Flush::Sync);
+        return out_.write(buffer_);
+    }
+
+    bool congested() const override { return out_.congested(); }
+
+    // Ends the compressed stream.
+    bool finish() {
+        buffer_.clear();
+        encoder_->encode({}, buffer_, compression::Encoder::Flush::Finish);
+        return out_.write(buffer_);
+    }
+
+private:
+    std::unique_ptr<compression::Encoder> encoder_;
+    ChunkWriter& out_;
+    std::string buffer_;
+};
+
+// Metadata values are stored as strings; non-string JSON values keep their
+// source text.
+std::unordered_map<std::string, std::string> metadata_from_json(const json::Value& object) {
+    std::unordered_map<std::string, std::string> result;
+    result.reserve(object.size());
+    object.for_each_member([&](std::string_view key, const json::Value& value) {
+        result.emplace(key, value.text());
+    });
+    return result;
+}
 
-    size_t end_pos = json.find(']', bracket_pos);
-    if (end_pos == std::string::npos) return result;
+std::string make_collection_name(const std::string& tenant_id, const std::string& ns) {
+    return tenant_id + "__" + ns;
+}
 
-    result.reserve(4096);
+}
 
-    size_t pos = bracket_pos + 1;
-    while (pos < end_pos) {
-        while (pos < end_pos && (json[pos] == ' ' || json[pos] == ',' ||
-               json[pos] == '\n' || json[pos] == '\r' || json[pos] == '\t')) {
-            pos++;
+struct HTTPServer::Connection {
+    // The socket is closed only once the last reference goes, so a worker
+    // still reading an upload never sees its descriptor reused.
+    ~Connection() {
+        if (fd >= 0) close(fd);
+    }
+
+    int fd = -1;
+    // The reactor that accepted the connection; the only thread touching it.
+    Shard* shard = nullptr;
+    ByteBuffer in;
+    HTTPRequestParser parser;
+    // Output not yet on the wire, oldest first; out_sent is how much of the
+    // front buffer has gone. Queued buffers never move, so the kernel can
+    // keep sending from them while more output is appended.
+    std::deque<std::string> out;
+    size_t out_sent = 0;
+    // io_uring only: the gather list of the send in flight.
+    iovec send_iov[SEND_IOV_MAX];
+    msghdr send_msg{};
+    bool recv_inflight = false;
+    bool send_inflight = false;
+    bool hangup_poll_inflight = false;
+    int buffer_slot = -1;
+    const char* buffer_base = nullptr;
+    size_t requests_served = 0;
+    bool busy = false;
+    bool close_after_write = false;
+    std::atomic<bool> closed{false};
+    std::chrono::steady_clock::time_point last_active = std::chrono::steady_clock::now();
+
+    // Bytes queued in out (or on their way there) that are not yet on the
+    // wire; a streaming worker waits on drained while this is too high.
+    std::atomic<size_t> pending{0};
+    std::mutex drain_mutex;
+    std::condition_variable drained;
+
+    void queue(std::string data) {
+        if (!data.empty()) out.push_back(std::move(data));
+    }
+
+    // Points iov at the unsent output; returns how many entries it used.
+    size_t gather(iovec* iov, size_t max) const {
+        size_t count = 0;
+        size_t skip = out_sent;
+        for (auto it = out.begin(); it != out.end() && count < max; ++it) {
+            iov[count].iov_base = const_cast<char*>(it->data()) + skip;
+            iov[count].iov_len = it->size() - skip;
+            skip = 0;
+            ++count;
         }
-        if (pos >= end_pos) break;
+        return count;
+    }
 
-        size_t num_start = pos;
-        while (pos < end_pos && (json[pos] == '-' || json[pos] == '+' ||
-               json[pos] == '.' || json[pos] == 'e' || json[pos] == 'E' ||
-               (json[pos] >= '0' && json[pos] <= '9'))) {
-            pos++;
+    // Drops the bytes a send put on the wire.
+    void consume(size_t bytes) {
+        while (bytes > 0) {
+            size_t left = out.front().size() - out_sent;
+            if (bytes < left) {
+                out_sent += bytes;
+                return;
+            }
+            bytes -= left;
+            out.pop_front();
+            out_sent = 0;
         }
+    }
 
-        if (pos > num_start) {
-            try {
-                result.push_back(std::stof(json.substr(num_start, pos - num_start)));
-            } catch (...) {}
+    // Reactor side: bytes reached the socket.
+    void release(size_t bytes) {
+        size_t before = pending.fetch_sub(bytes);
+        if (before > STREAM_LOW_WATER && before - bytes <= STREAM_LOW_WATER) {
+            std::lock_guard lock(drain_mutex);
+            drained.notify_all();
         }
     }
-
-    return result;
-}
-
-std::string float_array_to_json(const std::vector<float>& arr) {
-    std::ostringstream oss;
-    oss << "[";
-    for (size_t i = 0; i < arr.size(); ++i) {
-        if (i > 0) oss << ",";
-        oss << arr[i];
+};
+
+// One reactor thread with its own listening socket (SO_REUSEPORT when
+// there are several), epoll set and connections. Workers hand it output
+// through `completions` and `wake_fd`.
+struct HTTPServer::Shard {
+    size_t index = 0;
+    int cpu = -1;
+    std::thread thread;
+
+    int listen_fd = -1;
+    int unix_listen_fd = -1;
+    int epoll_fd = -1;
+    int wake_fd = -1;
+    std::unordered_map<int, std::shared_ptr<Connection>> connections;
+
+    std::mutex completions_mutex;
+    std::vector<Completion> completions;
+
+    std::atomic<uint64_t> accepted{0};
+    std::atomic<uint64_t> requests{0};
+    std::atomic<size_t> open_connections{0};
+
+    // io_uring backend only.
+    std::unique_ptr<IoUring> ring;
+    uint64_t wake_count = 0;
+    std::vector<unsigned> free_buffer_slots;
+    // Closed connections the kernel may still be reading into or sending
+    // from; dropped once their last operation completes.
+    std::unordered_map<Connection*, std::shared_ptr<Connection>> draining;
+};
+
+class HTTPServer::ConnectionWriter : public ChunkWriter {
+public:
+    ConnectionWriter(HTTPServer& server, const std::shared_ptr<Connection>& conn)
+        : server_(server), conn_(conn) {}
+
+    bool write(std::string_view data) override {
+        if (conn_->closed || stalled_) return false;
+        if (data.empty()) return true;
+
+        std::string chunk;
+        chunk.reserve(data.size() + 16);
+        char size_hex[16];
+        auto [end, ec] = std::to_chars(size_hex, size_hex + sizeof(size_hex), data.size(), 16);
+        chunk.append(size_hex, end);
+        chunk.append("\r\n");
+        chunk.append(data);
+        chunk.append("\r\n");
+        server_.complete(conn_, std::move(chunk), false);
+
+        if (congested()) {
+            std::unique_lock lock(conn_->drain_mutex);
+            stalled_ = !conn_->drained.wait_for(lock, CLIENT_TIMEOUT, [this] {
+                return conn_->closed || conn_->pending <= STREAM_LOW_WATER;
+            });
+        }
+        return !stalled_ && !conn_->closed;
     }
-    oss << "]";
-    return oss.str();
-}
 
-std::string metadata_to_json(const std::unordered_map<std::string, std::string>& meta) {
-    std::ostringstream oss;
-    oss << "{";
-    bool first = true;
-    for (const auto& [k, v] : meta) {
-        if (!first) oss << ",";
-        oss << "\"" << k << "\":\"" << v << "\"";
-        first = false;
+    bool congested() const override {
+        return conn_->pending > STREAM_HIGH_WATER;
     }
-    oss << "}";
-    return oss.str();
-}
 
-std::string make_collection_name(const std::string& tenant_id, const std::string& ns) {
-    return tenant_id + "__" + ns;
-}
+    bool stalled() const { return stalled_; }
 
-}
+private:
+    HTTPServer& server_;
+    const std::shared_ptr<Connection>& conn_;
+    bool stalled_ = false;
+};
 
-HTTPServer::HTTPServer(int port, std::shared_ptr<VectorStorage> storage)
-    : port_(port), storage_(std::move(storage)) {}
+// Reads the rest of a streamed upload on the worker. The reactor leaves a
+// busy connection's socket alone, so the worker is its only reader.
+class HTTPServer::SocketReader : public BodyReader {
+public:
+    SocketReader(std::shared_ptr<Connection> conn, size_t remaining)
+        : conn_(std::move(conn)), remaining_(remaining) {}
+
+    long read(char* dest, size_t len) override {
+        if (remaining_ == 0) return 0;
+        len = std::min(len, remaining_);
+        while (!conn_->closed) {
+            ssize_t n = ::read(conn_->fd, dest, len);
+            if (n > 0) {
+                remaining_ -= n;
+                return n;
+            }
+            if (n == 0) return -1;
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) return -1;
+
+            pollfd pfd{conn_->fd, POLLIN, 0};
+            int ready = poll(&pfd, 1, std::chrono::milliseconds(CLIENT_TIMEOUT).count());
+            if (ready == 0) return -1;
+            if (ready < 0 && errno != EINTR) return -1;
+        }
+        return -1;
+    }
+
+    size_t remaining() const override { return remaining_; }
+
+private:
+    std::shared_ptr<Connection> conn_;
+    size_t remaining_;
+};
+
+HTTPServer::HTTPServer(const HTTPServerConfig& config, std::shared_ptr<VectorStorage> storage,
+                       std::shared_ptr<AdmissionController> admission,
+                       std::shared_ptr<LatencyMetrics> metrics)
+    : config_(config), storage_(std::move(storage)), admission_(std::move(admission))
+    , metrics_(std::move(metrics)) {
+    if (!admission_) admission_ = std::make_shared<AdmissionController>();
+    if (!metrics_) metrics_ = std::make_shared<LatencyMetrics>();
+    config_.num_workers = std::max<size_t>(1, config_.num_workers);
+    config_.num_shards = std::max<size_t>(1, config_.num_shards);
+    config_.max_requests_per_connection = std::max<size_t>(1, config_.max_requests_per_connection);
+    build_routes();
+}
 
 HTTPServer::~HTTPServer() {
     stop();
 }
 
 void HTTPServer::start() {
+    workers_ = std::make_unique<ThreadPool>(config_.num_workers);
     running_ = true;
-    server_thread_ = std::thread(&HTTPServer::run_server, this);
+    for (size_t i = 0; i < config_.num_shards; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->index = i;
+        if (!config_.shard_cpus.empty()) {
+            shard->cpu = config_.shard_cpus[i % config_.shard_cpus.size()];
+        }
+        shard->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        shards_.push_back(std::move(shard));
+    }
+    for (auto& shard : shards_) {
+        shard->thread = std::thread(&HTTPServer::run_shard, this, std::ref(*shard));
+    }
 }
 
 void HTTPServer::stop() {
     running_ = false;
-    if (server_thread_.joinable()) {
-        server_thread_.join();
+    for (auto& shard : shards_) {
+        if (shard->wake_fd >= 0) {
+            uint64_t one = 1;
+            [[maybe_unused]] auto n = write(shard->wake_fd, &one, sizeof(one));
+        }
+    }
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+    if (workers_) {
+        workers_->shutdown();
+        workers_.reset();
+    }
+    for (auto& shard : shards_) {
+        if (shard->wake_fd >= 0) {
+            close(shard->wake_fd);
+            shard->wake_fd = -1;
+        }
+    }
+    shards_.clear();
+}
+
+std::vector<HTTPServer::ShardStats> HTTPServer::shard_stats() const {
+    std::vector<ShardStats> stats;
+    stats.reserve(shards_.size());
+    for (const auto& shard : shards_) {
+        stats.push_back({shard->index, shard->cpu, shard->accepted.load(),
+                         shard->requests.load(), shard->open_connections.load()});
     }
+    return stats;
 }
 
-void HTTPServer::run_server() {
-    int server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd < 0) {
+bool HTTPServer::open_listener(Shard& shard) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
         std::cerr << "Failed to create socket" << std::endl;
-        return;
+        return false;
     }
 
     int opt = 1;
-    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    // Every shard binds the same port; the kernel balances new connections
+    // across their accept queues, so shards never contend on one.
+    if (config_.num_shards > 1) {
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
+    }
 
-    int recv_buf_size = 16 * 1024 * 1024;
-    int send_buf_size = 16 * 1024 * 1024;
-    setsockopt(server_fd, SOL_SOCKET, SO_RCVBUF, &recv_buf_size, sizeof(recv_buf_size));
-    setsockopt(server_fd, SOL_SOCKET, SO_SNDBUF, &send_buf_size, sizeof(send_buf_size));
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &SOCKET_BUFFER_SIZE, sizeof(SOCKET_BUFFER_SIZE));
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &SOCKET_BUFFER_SIZE, sizeof(SOCKET_BUFFER_SIZE));
 
     sockaddr_in address{};
     address.sin_family = AF_INET;
     address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port = htons(port_);
+    address.sin_port = htons(config_.port);
 
-    if (bind(server_fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
-        std::cerr << "Failed to bind to port " << port_ << std::endl;
-        close(server_fd);
-        return;
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        std::cerr << "Failed to bind to port " << config_.port << std::endl;
+        close(fd);
+        return false;
     }
 
-    if (listen(server_fd, 128) < 0) {
+    if (listen(fd, 1024) < 0) {
         std::cerr << "Failed to listen" << std::endl;
-        close(server_fd);
-        return;
+        close(fd);
+        return false;
     }
 
-    std::cout << "HTTP Server listening on port " << port_ << std::endl;
-    std::cout << "Max payload: 500MB+ | Parallel search: 100K+" << std::endl;
+    shard.listen_fd = fd;
+    return true;
+}
 
-    timeval tv{};
-    tv.tv_sec = 1;
-    tv.tv_usec = 0;
-    setsockopt(server_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+bool HTTPServer::open_unix_listener(Shard& shard) {
+    sockaddr_un address{};
+    if (config_.unix_socket.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Unix socket path too long: " << config_.unix_socket << std::endl;
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, config_.unix_socket.data(), config_.unix_socket.size());
 
-    constexpr size_t BUFFER_SIZE = 1024 * 1024;
-    std::vector<char> buffer(BUFFER_SIZE);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::cerr << "Failed to create Unix socket" << std::endl;
+        return false;
+    }
 
-    while (running_) {
-        sockaddr_in client_addr{};
-        socklen_t client_len = sizeof(client_addr);
-        int client_fd = accept(server_fd, (struct sockaddr*)&client_addr, &client_len);
+    // A socket file left behind by a previous run would make bind() fail.
+    unlink(config_.unix_socket.c_str());
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0 || listen(fd, 1024) < 0) {
+        std::cerr << "Failed to listen on " << config_.unix_socket << ": "
+                  << std::strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+    // Clients in other containers may run as another user; who can reach
+    // the socket is decided by who can reach its directory.
+    chmod(config_.unix_socket.c_str(), 0666);
 
-        if (client_fd < 0) continue;
+    shard.unix_listen_fd = fd;
+    return true;
+}
 
-        setsockopt(client_fd, SOL_SOCKET, SO_RCVBUF, &recv_buf_size, sizeof(recv_buf_size));
-        setsockopt(client_fd, SOL_SOCKET, SO_SNDBUF, &send_buf_size, sizeof(send_buf_size));
+void HTTPServer::run_shard(Shard& shard) {
+    if (shard.cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(shard.cpu, &cpus);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) {
+            std::cerr << "HTTP shard " << shard.index << ": could not pin to CPU "
+                      << shard.cpu << std::endl;
+        }
+    }
 
-        timeval client_tv{};
-        client_tv.tv_sec = 300;
-        client_tv.tv_usec = 0;
-        setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &client_tv, sizeof(client_tv));
-        setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &client_tv, sizeof(client_tv));
+    if (!open_listener(shard)) return;
+    // SO_REUSEPORT doesn't apply to Unix sockets; the first shard serves it.
+    if (shard.index == 0 && !config_.unix_socket.empty() && !open_unix_listener(shard)) {
+        close(shard.listen_fd);
+        shard.listen_fd = -1;
+        return;
+    }
 
-        std::string request;
-        ssize_t bytes;
+    bool uring = config_.io_backend == IOBackend::IoUring && setup_uring(shard);
 
-        bytes = read(client_fd, buffer.data(), buffer.size() - 1);
-        if (bytes > 0) {
-            buffer[bytes] = '\0';
-            request.assign(buffer.data(), bytes);
+    if (shard.index == 0) {
+        std::cout << "HTTP Server listening on port " << config_.port
+                  << " (" << (uring ? "io_uring" : "epoll") << ", " << config_.num_shards
+                  << " shards, " << config_.num_workers << " workers, keep-alive "
+                  << config_.idle_timeout.count() << "s / "
+                  << config_.max_requests_per_connection << " requests)" << std::endl;
+        if (shard.unix_listen_fd >= 0) {
+            std::cout << "HTTP Server listening on unix:" << config_.unix_socket << std::endl;
         }
+        std::cout << "Max payload: 500MB+ | Parallel search: 100K+" << std::endl;
+    }
 
-        size_t content_length = 0;
-        std::string cl_header = "Content-Length:";
-        auto cl_pos = request.find(cl_header);
-        if (cl_pos != std::string::npos) {
-            auto cl_end = request.find("\r\n", cl_pos);
-            std::string cl_val = request.substr(cl_pos + cl_header.length(), cl_end - cl_pos - cl_header.length());
-            size_t start = cl_val.find_first_not_of(" \t");
-            if (start != std::string::npos) {
-                cl_val = cl_val.substr(start);
-            }
-            content_length = std::stoull(cl_val);
-        }
+    if (uring) {
+        run_uring_loop(shard);
+    } else {
+        run_epoll_loop(shard);
+    }
 
-        auto header_end = request.find("\r\n\r\n");
-        if (header_end != std::string::npos && content_length > 0) {
-            size_t header_size = header_end + 4;
-            size_t body_received = request.length() - header_size;
+    close(shard.listen_fd);
+    shard.listen_fd = -1;
+    if (shard.unix_listen_fd >= 0) {
+        close(shard.unix_listen_fd);
+        shard.unix_listen_fd = -1;
+        unlink(config_.unix_socket.c_str());
+    }
+}
 
-            if (content_length > body_received) {
-                request.reserve(header_size + content_length + 1);
-            }
+void HTTPServer::run_epoll_loop(Shard& shard) {
+    shard.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (shard.epoll_fd < 0) {
+        std::cerr << "Failed to create epoll instance" << std::endl;
+        return;
+    }
 
-            while (body_received < content_length) {
-                size_t remaining = content_length - body_received;
-                size_t to_read = std::min(remaining, buffer.size() - 1);
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = shard.listen_fd;
+    epoll_ctl(shard.epoll_fd, EPOLL_CTL_ADD, shard.listen_fd, &ev);
 
-                bytes = read(client_fd, buffer.data(), to_read);
-                if (bytes <= 0) {
-                    if (bytes == 0) break;
-                    if (errno == EAGAIN || errno == EWOULDBLOCK) continue;
-                    break;
-                }
+    if (shard.unix_listen_fd >= 0) {
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.fd = shard.unix_listen_fd;
+        epoll_ctl(shard.epoll_fd, EPOLL_CTL_ADD, shard.unix_listen_fd, &ev);
+    }
 
-                request.append(buffer.data(), bytes);
-                body_received += bytes;
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = shard.wake_fd;
+    epoll_ctl(shard.epoll_fd, EPOLL_CTL_ADD, shard.wake_fd, &ev);
 
-                if (content_length > 50 * 1024 * 1024 && body_received % (50 * 1024 * 1024) < static_cast<size_t>(bytes)) {
-                    std::cout << "Receiving: " << (body_received / (1024 * 1024)) << "MB / "
-                              << (content_length / (1024 * 1024)) << "MB" << std::endl;
-                }
-            }
+    constexpr int MAX_EVENTS = 256;
+    std::vector<epoll_event> events(MAX_EVENTS);
+    auto last_sweep = std::chrono::steady_clock::now();
+    while (running_) {
+        int n = epoll_wait(shard.epoll_fd, events.data(), MAX_EVENTS, 1000);
+        if (n < 0 && errno != EINTR) {
+            std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+            break;
         }
 
-        if (!request.empty()) {
-            std::string method, path;
-            std::istringstream iss(request);
-            iss >> method >> path;
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            uint32_t flags = events[i].events;
 
-            std::string body;
-            auto body_pos = request.find("\r\n\r\n");
-            if (body_pos != std::string::npos) {
-                body = request.substr(body_pos + 4);
+            if (fd == shard.listen_fd || fd == shard.unix_listen_fd) {
+                accept_connections(shard, fd);
+                continue;
             }
 
-            std::string response = handle_request(method, path, body);
+            if (fd == shard.wake_fd) {
+                uint64_t count;
+                while (read(shard.wake_fd, &count, sizeof(count)) > 0) {}
+                drain_completions(shard);
+                continue;
+            }
 
-            size_t total_sent = 0;
-            while (total_sent < response.size()) {
-                ssize_t sent = write(client_fd, response.c_str() + total_sent, response.size() - total_sent);
-                if (sent <= 0) break;
-                total_sent += sent;
+            auto it = shard.connections.find(fd);
+            if (it == shard.connections.end()) continue;
+            auto conn = it->second;
+
+            // The socket is left unread while a worker owns the connection,
+            // so a reset is only noticed here; closing it lets searches for a
+            // client that is no longer waiting stop early. A half-close is
+            // not a hangup: a client may shut down its side after sending a
+            // request and still read the response.
+            if (flags & (EPOLLERR | EPOLLHUP)) {
+                close_connection(conn);
+                continue;
+            }
+            if (flags & EPOLLIN) {
+                on_readable(conn);
+            }
+            if ((flags & EPOLLOUT) && !conn->closed && !conn->out.empty()) {
+                flush(conn);
             }
         }
 
-        close(client_fd);
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_sweep >= std::chrono::seconds(1)) {
+            close_idle_connections(shard);
+            last_sweep = now;
+        }
     }
 
-    close(server_fd);
+    while (!shard.connections.empty()) {
+        auto conn = shard.connections.begin()->second;
+        close_connection(conn);
+    }
+    close(shard.epoll_fd);
+    shard.epoll_fd = -1;
 }
 
-std::string HTTPServer::handle_request(const std::string& method,
-                                        const std::string& path,
-                                        const std::string& body) {
-    try {
-        if (method == "GET" && path == "/health") return handle_health();
-        if (method == "GET" && path == "/collections") return handle_list_collections();
-        if (method == "POST" && path == "/collections") return handle_create_collection(body);
-        if (method == "POST" && path == "/search") return handle_search(body);
-        if (method == "POST" && path == "/batch_search") return handle_batch_search(body);
-        if (method == "POST" && path == "/insert") return handle_insert(body);
-        if (method == "POST" && path == "/batch_insert") return handle_batch_insert(body);
-        if (method == "POST" && path == "/search_with_filter") return handle_search_with_filter(body);
-        if (method == "POST" && path == "/save") return handle_save(parse_json_string(body, "collection"));
-        if (method == "POST" && path == "/save_all") return handle_save("");
-
-        if (path.rfind("/collections/", 0) == 0) {
-            std::string name = path.substr(13);
-            if (method == "DELETE") return handle_delete_collection(name);
-            if (method == "GET") return handle_stats(name);
+void HTTPServer::accept_connections(Shard& shard, int listen_fd) {
+    while (true) {
+        int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
         }
 
-        if (path.rfind("/stats/", 0) == 0) {
-            return handle_stats(path.substr(7));
+        auto conn = add_connection(shard, client_fd, listen_fd == shard.listen_fd);
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+        ev.data.fd = client_fd;
+        if (epoll_ctl(shard.epoll_fd, EPOLL_CTL_ADD, client_fd, &ev) < 0) {
+            close_connection(conn);
         }
+    }
+}
+
+std::shared_ptr<HTTPServer::Connection> HTTPServer::add_connection(Shard& shard, int client_fd,
+                                                                   bool tcp) {
+    setsockopt(client_fd, SOL_SOCKET, SO_RCVBUF, &SOCKET_BUFFER_SIZE, sizeof(SOCKET_BUFFER_SIZE));
+    setsockopt(client_fd, SOL_SOCKET, SO_SNDBUF, &SOCKET_BUFFER_SIZE, sizeof(SOCKET_BUFFER_SIZE));
+    if (tcp) {
+        int nodelay = 1;
+        setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    }
+
+    auto conn = std::make_shared<Connection>();
+    conn->fd = client_fd;
+    conn->shard = &shard;
+    shard.connections[client_fd] = conn;
+    shard.accepted.fetch_add(1, std::memory_order_relaxed);
+    shard.open_connections.fetch_add(1, std::memory_order_relaxed);
+    return conn;
+}
+
+void HTTPServer::on_readable(const std::shared_ptr<Connection>& conn) {
+    // While a handler owns a request, or a response is still queued, further
+    // bytes stay in the socket; drain_completions() and flush() come back here
+    // once the connection can take the next request.
+    if (conn->busy || conn->closed || conn->close_after_write || !conn->out.empty()) {
+        return;
+    }
+
+    if (conn->shard->ring) {
+        uring_recv(conn);
+        return;
+    }
+
+    auto& in = conn->in;
+    while (true) {
+        make_room(conn->parser, in);
 
-        if (path.rfind("/index/", 0) == 0) {
-            return handle_index_stats(path.substr(7));
+        ssize_t bytes = read(conn->fd, in.tail(), in.available());
+        if (bytes > 0) {
+            on_received(conn, bytes);
+            if (conn->busy || conn->closed || conn->close_after_write) return;
+            continue;
         }
 
-        if (path.rfind("/count/", 0) == 0) {
-            return handle_count(path.substr(7));
+        if (bytes == 0) {
+            close_connection(conn);
+            return;
         }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+
+        close_connection(conn);
+        return;
+    }
+}
+
+void HTTPServer::on_received(const std::shared_ptr<Connection>& conn, size_t bytes) {
+    auto& parser = conn->parser;
+    auto& in = conn->in;
+    size_t before = in.size();
+    in.commit(bytes);
+    conn->last_active = std::chrono::steady_clock::now();
+
+    if (parser.head_complete() && parser.request().content_length > LARGE_BODY_LOG_STEP &&
+        in.size() / LARGE_BODY_LOG_STEP != before / LARGE_BODY_LOG_STEP) {
+        size_t body_received = in.size() - parser.head_size();
+        std::cout << "Receiving: " << (body_received / (1024 * 1024)) << "MB / "
+                  << (parser.request().content_length / (1024 * 1024)) << "MB" << std::endl;
+    }
+
+    process_input(conn);
+}
+
+void HTTPServer::process_input(const std::shared_ptr<Connection>& conn) {
+    if (conn->busy || conn->closed || conn->close_after_write || conn->in.empty()) return;
 
-        if (path.rfind("/vectors/", 0) == 0) {
-            auto second_slash = path.find('/', 9);
-            if (second_slash != std::string::npos) {
-                std::string collection = path.substr(9, second_slash - 9);
-                std::string id = path.substr(second_slash + 1);
-                if (method == "GET") return handle_get_vector(collection, id);
-                if (method == "PUT") return handle_update_vector(collection, id, body);
-                if (method == "DELETE") return handle_delete_vector(collection, id);
+    auto& parser = conn->parser;
+    auto status = parser.parse(conn->in.data(), conn->in.size());
+
+    if (status == HTTPRequestParser::Status::Error) {
+        queue_response(conn, error_response(parser.error_code(), parser.error_message()), false);
+        conn->close_after_write = true;
+        flush(conn);
+        return;
+    }
+
+    // Streamed uploads go to a worker as soon as the head is parsed, so
+    // records are processed while the rest of the body is still arriving.
+    if (parser.head_complete()) {
+        RouteParams params;
+        const Route* route = find_route(parser.request(), params);
+        if (route && route->streamed_upload) {
+            dispatch(conn);
+            return;
+        }
+        if (parser.request().content_length > config_.max_body_size) {
+            queue_response(conn, error_response(413, "Body exceeds " +
+                                                std::to_string(config_.max_body_size) + " bytes"), false);
+            conn->close_after_write = true;
+            flush(conn);
+            return;
+        }
+    }
+
+    // Size the buffer for the whole message once, so a body is read
+    // straight into its final place (past MAX_BODY_PRESIZE, in a few steps).
+    if (parser.head_complete()) {
+        conn->in.reserve(receive_target(parser, conn->in));
+    }
+
+    if (status == HTTPRequestParser::Status::Complete) {
+        dispatch(conn);
+    }
+}
+
+void HTTPServer::dispatch(const std::shared_ptr<Connection>& conn) {
+    auto& parser = conn->parser;
+    size_t head_size = parser.head_size();
+    size_t message_size = parser.message_size();
+    // A streamed upload may leave here before its body has fully arrived.
+    // The parser rejects a Content-Length that would wrap message_size, and
+    // the head is always in the buffer; the clamp keeps the body view from
+    // ever starting past its end.
+    size_t consumed = std::max(head_size, std::min(message_size, conn->in.size()));
+
+    // The request takes the connection's buffer with it; anything past this
+    // message is the start of a pipelined request and moves to a fresh buffer.
+    HTTPRequest request = std::move(parser.request());
+    ByteBuffer rest;
+    if (conn->in.size() > consumed) {
+        rest.reserve(std::max(READ_CHUNK_SIZE, conn->in.size() - consumed));
+        rest.append(conn->in.data() + consumed, conn->in.size() - consumed);
+    }
+    request.buffer = std::move(conn->in);
+    request.body = request.buffer.view(head_size, consumed - head_size);
+    if (const auto* header = request.header("X-Request-Deadline")) {
+        uint64_t unix_ms = 0;
+        auto [end, ec] = std::from_chars(header->data(), header->data() + header->size(), unix_ms);
+        if (ec == std::errc()) {
+            request.deadline = Deadline::at_system_time(
+                std::chrono::system_clock::time_point(std::chrono::milliseconds(unix_ms)));
+        }
+    }
+    request.deadline.set_cancel_check([conn] { return conn->closed.load(); });
+    if (consumed < message_size) {
+        request.body_reader = std::make_unique<SocketReader>(conn, message_size - consumed);
+    }
+    conn->in = std::move(rest);
+    parser.reset();
+
+    conn->requests_served++;
+    conn->shard->requests.fetch_add(1, std::memory_order_relaxed);
+    bool keep_alive = request.keep_alive() &&
+                      conn->requests_served < config_.max_requests_per_connection;
+    conn->close_after_write = !keep_alive;
+
+    // Health checks and metrics bypass admission so they stay reachable under load.
+    RouteParams params;
+    const Route* route = find_route(request, params);
+    AdmissionController::Ticket ticket;
+    if (!route || !route->admission_exempt) {
+        AdmissionController::Rejection rejection;
+        ticket = admission_->admit(rejection);
+        // A collection named in the path is charged to its tenant now, as gRPC
+        // calls are, so one tenant's burst can't fill the worker queue; the
+        // rest are charged once a worker has parsed the body.
+        std::string_view collection;
+        if (ticket && route && route->scope == RouteScope::Param) {
+            collection = params[0];
+            if (!admission_->admit_tenant(ticket, collection, rejection)) {
+                ticket = {};
             }
         }
+        if (!ticket) {
+            // Shed here in the reactor: answering now is cheaper than queueing
+            // work that would only add to the backlog. The answer is posted
+            // back like a worker's rather than flushed here, since flush()
+            // serves the next pipelined request and would recurse through
+            // every rejection a client has buffered.
+            bool reuse = keep_alive && !request.body_reader;
+            HTTPResponse response = rejection_response(rejection, collection);
+            conn->busy = true;
+            complete(conn, serialize_head(response, reuse, config_), true, !reuse,
+                     std::move(response.body));
+            return;
+        }
+    }
+    conn->busy = true;
+    if (conn->shard->ring) uring_watch_hangup(conn);
+    auto start = LatencyHistogram::clock::now();
+
+    // std::function needs a copyable target, so the move-only request and
+    // ticket ride in shared_ptrs.
+    auto shared_request = std::make_shared<HTTPRequest>(std::move(request));
+    auto shared_ticket = std::make_shared<AdmissionController::Ticket>(std::move(ticket));
+    workers_->submit([this, conn, keep_alive, route, start, request = std::move(shared_request),
+                      ticket = std::move(shared_ticket)]() {
+        // Timed from admission until the response is handed to the reactor;
+        // a streamed one, once its last chunk is.
+        std::string collection;
+        HTTPResponse response = handle_request(*request, *ticket, collection);
+        encode_response(*request, response);
+        if (response.stream) {
+            stream_response(conn, response, keep_alive, *request);
+            if (route) metrics_->record(collection, route->name, LatencyHistogram::clock::now() - start);
+            return;
+        }
+        // A handler that answered without reading all of a streamed upload
+        // leaves the rest on the socket, so the connection can't be reused.
+        bool unread = request->body_unread();
+        // The body goes out as its own buffer, behind the head, rather than
+        // being copied in after it.
+        std::string head = serialize_head(response, keep_alive && !unread, config_);
+        if (route) metrics_->record(collection, route->name, LatencyHistogram::clock::now() - start);
+        complete(conn, std::move(head), true, unread, std::move(response.body));
+    });
+}
 
-        return route_tenant_endpoints(method, path, body);
+void HTTPServer::stream_response(const std::shared_ptr<Connection>& conn,
+                                 const HTTPResponse& response, bool keep_alive,
+                                 const HTTPRequest& request) {
+    complete(conn, serialize_head(response, keep_alive, config_), false);
 
+    ConnectionWriter writer(*this, conn);
+    try {
+        if (auto encoder = compression::Encoder::create(response.content_encoding)) {
+            EncodingWriter encoded(std::move(encoder), writer);
+            response.stream(encoded);
+            encoded.finish();
+        } else {
+            response.stream(writer);
+        }
     } catch (const std::exception& e) {
-        return error_response(500, e.what());
+        // The status line is already out, so the only way left to report the
+        // failure is to cut the body short.
+        std::cerr << "Streamed response aborted: " << e.what() << std::endl;
+        complete(conn, {}, true, true);
+        return;
+    }
+    if (writer.stalled()) {
+        complete(conn, {}, true, true);
+        return;
+    }
+    complete(conn, "0\r\n\r\n", true, request.body_unread());
+}
+
+void HTTPServer::complete(const std::shared_ptr<Connection>& conn, std::string data,
+                          bool last, bool abort, std::string body) {
+    conn->pending += data.size() + body.size();
+    Shard& shard = *conn->shard;
+    {
+        std::lock_guard lock(shard.completions_mutex);
+        shard.completions.push_back({conn, std::move(data), std::move(body), last, abort});
+    }
+    uint64_t one = 1;
+    [[maybe_unused]] auto n = write(shard.wake_fd, &one, sizeof(one));
+}
+
+void HTTPServer::drain_completions(Shard& shard) {
+    std::vector<Completion> done;
+    {
+        std::lock_guard lock(shard.completions_mutex);
+        done.swap(shard.completions);
+    }
+
+    for (auto& completion : done) {
+        auto& conn = completion.conn;
+        if (conn->closed) continue;
+        if (completion.last) conn->busy = false;
+        if (completion.abort) conn->close_after_write = true;
+        conn->queue(std::move(completion.data));
+        conn->queue(std::move(completion.body));
+        conn->last_active = std::chrono::steady_clock::now();
+    }
+
+    // Flush once per connection, after all of its chunks in this batch are queued.
+    for (auto& completion : done) {
+        if (!completion.conn->closed) flush(completion.conn);
     }
 }
 
-std::string HTTPServer::route_tenant_endpoints(const std::string& method,
-                                                const std::string& path,
-                                                const std::string& body) {
-    if (path.rfind("/tenants/", 0) != 0) {
-        return error_response(404, "Not found");
+void HTTPServer::flush(const std::shared_ptr<Connection>& conn) {
+    // With io_uring the send completes in uring_complete(), which calls
+    // back here to continue.
+    if (conn->shard->ring) {
+        if (conn->send_inflight) return;
+        if (!conn->out.empty()) {
+            uring_send(conn);
+            return;
+        }
+    }
+
+    while (!conn->out.empty()) {
+        // sendmsg() rather than writev() for MSG_NOSIGNAL.
+        iovec iov[SEND_IOV_MAX];
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = conn->gather(iov, SEND_IOV_MAX);
+        ssize_t sent = sendmsg(conn->fd, &msg, MSG_NOSIGNAL);
+        if (sent > 0) {
+            conn->consume(sent);
+            conn->release(sent);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+
+        close_connection(conn);
+        return;
+    }
+
+    if (conn->busy) return;
+    if (conn->close_after_write) {
+        close_connection(conn);
+        return;
     }
 
-    std::string rest = path.substr(9);
-    size_t slash1 = rest.find('/');
+    // The response is on the wire: serve a pipelined request that is already
+    // buffered, then pick up whatever arrived while this one was in flight.
+    process_input(conn);
+    on_readable(conn);
+}
+
+void HTTPServer::close_connection(const std::shared_ptr<Connection>& conn) {
+    if (conn->closed) return;
+    {
+        // Wake a streaming worker blocked on this connection so it can stop.
+        std::lock_guard lock(conn->drain_mutex);
+        conn->closed = true;
+    }
+    conn->drained.notify_all();
+    Shard& shard = *conn->shard;
+    epoll_ctl(shard.epoll_fd, EPOLL_CTL_DEL, conn->fd, nullptr);
+    // Shut down rather than close: a worker may still hold the connection,
+    // and this also wakes one blocked reading an upload.
+    shutdown(conn->fd, SHUT_RDWR);
+    shard.connections.erase(conn->fd);
+    shard.open_connections.fetch_sub(1, std::memory_order_relaxed);
+
+    if (shard.ring) {
+        uring_release_buffer(conn);
+        if (conn->recv_inflight || conn->send_inflight || conn->hangup_poll_inflight) {
+            shard.draining[conn.get()] = conn;
+        }
+    }
+}
 
-    if (slash1 == std::string::npos) {
-        return error_response(404, "Not found");
+void HTTPServer::close_idle_connections(Shard& shard) {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<Connection>> idle;
+    for (const auto& [fd, conn] : shard.connections) {
+        if (conn->busy) continue;
+        // A half-received request gets the long upload timeout; a connection
+        // parked between requests only gets the keep-alive idle timeout.
+        auto limit = !conn->in.empty() || !conn->out.empty()
+            ? CLIENT_TIMEOUT
+            : config_.idle_timeout;
+        if (now - conn->last_active > limit) {
+            idle.push_back(conn);
+        }
     }
+    for (const auto& conn : idle) {
+        close_connection(conn);
+    }
+}
 
-    std::string tenant_id = rest.substr(0, slash1);
-    std::string remaining = rest.substr(slash1 + 1);
+#ifdef VECTORDB_HAVE_IO_URING
+
+bool HTTPServer::setup_uring(Shard& shard) {
+    std::string error;
+    shard.ring = IoUring::create(URING_ENTRIES,
+                                 {IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SENDMSG, IORING_OP_READ,
+                                  IORING_OP_READ_FIXED, IORING_OP_POLL_ADD},
+                                 error);
+    if (!shard.ring) {
+        std::cerr << "HTTP shard " << shard.index << ": io_uring unavailable (" << error
+                  << "), using epoll" << std::endl;
+        return false;
+    }
+    // Without registered buffers large bodies are simply read with plain recvs.
+    if (shard.ring->register_buffer_slots(URING_BUFFER_SLOTS)) {
+        for (unsigned slot = URING_BUFFER_SLOTS; slot-- > 0;) {
+            shard.free_buffer_slots.push_back(slot);
+        }
+    }
 
-    if (remaining == "namespaces") {
-        if (method == "GET") return handle_list_namespaces(tenant_id);
-        if (method == "POST") return handle_create_namespace(tenant_id, body);
+    uring_accept(shard, shard.listen_fd);
+    if (shard.unix_listen_fd >= 0) {
+        uring_accept(shard, shard.unix_listen_fd);
     }
+    uring_read_wake(shard);
+    return true;
+}
+
+void HTTPServer::run_uring_loop(Shard& shard) {
+    auto last_sweep = std::chrono::steady_clock::now();
+    auto reap = [&](std::chrono::milliseconds timeout) {
+        shard.ring->submit_and_wait(timeout);
+        shard.ring->for_each_completion([&](const io_uring_cqe& cqe) {
+            uring_complete(shard, cqe.user_data, cqe.res);
+        });
+    };
 
-    if (remaining == "search") {
-        if (method == "POST") return handle_tenant_search(tenant_id, body);
+    while (running_) {
+        reap(std::chrono::milliseconds(1000));
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_sweep >= std::chrono::seconds(1)) {
+            close_idle_connections(shard);
+            last_sweep = now;
+        }
     }
 
-    if (remaining == "stats") {
-        if (method == "GET") return handle_tenant_stats(tenant_id);
+    while (!shard.connections.empty()) {
+        auto conn = shard.connections.begin()->second;
+        close_connection(conn);
     }
+    // The sockets are shut down, so whatever is still in flight completes
+    // promptly; wait for it before the buffers it uses go away.
+    for (int i = 0; i < 50 && !shard.draining.empty(); ++i) {
+        reap(std::chrono::milliseconds(100));
+    }
+    shard.ring.reset();
+    shard.draining.clear();
+    shard.free_buffer_slots.clear();
+}
+
+void HTTPServer::uring_complete(Shard& shard, uint64_t user_data, int result) {
+    uint64_t op = user_data & URING_OP_MASK;
 
-    size_t slash2 = remaining.find('/');
-    if (slash2 == std::string::npos) {
-        return error_response(404, "Not found");
+    if (op == URING_ACCEPT) {
+        int listen_fd = static_cast<int>(user_data >> URING_OP_BITS);
+        if (result >= 0) {
+            on_readable(add_connection(shard, result, listen_fd == shard.listen_fd));
+        }
+        if (running_) uring_accept(shard, listen_fd);
+        return;
+    }
+    if (op == URING_WAKE) {
+        drain_completions(shard);
+        if (running_) uring_read_wake(shard);
+        return;
     }
 
-    std::string ns = remaining.substr(0, slash2);
-    std::string action = remaining.substr(slash2 + 1);
+    static_assert(alignof(Connection) > URING_OP_MASK);
+    auto* raw = reinterpret_cast<Connection*>(user_data & ~URING_OP_MASK);
+    auto draining = shard.draining.find(raw);
+    std::shared_ptr<Connection> conn =
+        draining != shard.draining.end() ? draining->second : shard.connections.at(raw->fd);
+
+    switch (op) {
+        case URING_RECV:
+            conn->recv_inflight = false;
+            if (conn->closed) break;
+            if (result > 0) {
+                // Unregister before the buffer moves on with the request.
+                auto& parser = conn->parser;
+                if (parser.head_complete() && conn->in.size() + result >= parser.message_size()) {
+                    uring_release_buffer(conn);
+                }
+                on_received(conn, result);
+                on_readable(conn);
+            } else if (result == -EAGAIN || result == -EINTR) {
+                on_readable(conn);
+            } else {
+                close_connection(conn);
+            }
+            break;
+
+        case URING_SEND:
+            conn->send_inflight = false;
+            if (conn->closed) break;
+            if (result > 0) {
+                conn->consume(result);
+                conn->release(result);
+                flush(conn);
+            } else if (result == -EAGAIN || result == -EINTR) {
+                flush(conn);
+            } else {
+                close_connection(conn);
+            }
+            break;
+
+        case URING_HANGUP:
+            // Same as EPOLLERR/EPOLLHUP in run_epoll_loop().
+            conn->hangup_poll_inflight = false;
+            if (conn->closed || result <= 0) break;
+            if (result & (POLLERR | POLLHUP)) {
+                close_connection(conn);
+            }
+            break;
+    }
 
-    if (action == "faq") {
-        if (method == "POST") return handle_add_faq(tenant_id, ns, body);
+    if (conn->closed && !conn->recv_inflight && !conn->send_inflight &&
+        !conn->hangup_poll_inflight) {
+        shard.draining.erase(raw);
     }
+}
+
+void HTTPServer::uring_accept(Shard& shard, int listen_fd) {
+    io_uring_sqe* sqe = shard.ring->get_sqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_fd;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = static_cast<uint64_t>(listen_fd) << URING_OP_BITS | URING_ACCEPT;
+}
 
-    if (action == "faq/bulk") {
-        if (method == "POST") return handle_bulk_faq(tenant_id, ns, body);
+void HTTPServer::uring_read_wake(Shard& shard) {
+    io_uring_sqe* sqe = shard.ring->get_sqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = shard.wake_fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&shard.wake_count);
+    sqe->len = sizeof(shard.wake_count);
+    sqe->user_data = URING_WAKE;
+}
+
+void HTTPServer::uring_recv(const std::shared_ptr<Connection>& conn) {
+    if (conn->recv_inflight) return;
+    Shard& shard = *conn->shard;
+    auto& parser = conn->parser;
+    auto& in = conn->in;
+    make_room(parser, in);
+    size_t len = std::min<size_t>(in.available(), UINT32_MAX);
+
+    io_uring_sqe* sqe = shard.ring->get_sqe();
+    sqe->fd = conn->fd;
+    sqe->addr = reinterpret_cast<uint64_t>(in.tail());
+    sqe->len = static_cast<uint32_t>(len);
+    sqe->user_data = reinterpret_cast<uint64_t>(conn.get()) | URING_RECV;
+    conn->recv_inflight = true;
+
+    // A large body is read straight into its final buffer; register that
+    // buffer once for the whole body.
+    bool large = parser.head_complete() && parser.message_size() >= in.size() + URING_FIXED_BODY_MIN;
+    if (large && conn->buffer_base != in.data()) {
+        uring_release_buffer(conn);
+        if (!shard.free_buffer_slots.empty()) {
+            unsigned slot = shard.free_buffer_slots.back();
+            if (shard.ring->set_buffer(slot, in.data(), in.capacity())) {
+                shard.free_buffer_slots.pop_back();
+                conn->buffer_slot = static_cast<int>(slot);
+                conn->buffer_base = in.data();
+            }
+        }
     }
+    if (conn->buffer_slot >= 0 && conn->buffer_base == in.data()) {
+        sqe->opcode = IORING_OP_READ_FIXED;
+        sqe->buf_index = static_cast<uint16_t>(conn->buffer_slot);
+    } else {
+        sqe->opcode = IORING_OP_RECV;
+    }
+}
 
-    if (action == "search") {
-        if (method == "POST") return handle_namespace_search(tenant_id, ns, body);
+void HTTPServer::uring_send(const std::shared_ptr<Connection>& conn) {
+    conn->send_msg = msghdr{};
+    conn->send_msg.msg_iov = conn->send_iov;
+    conn->send_msg.msg_iovlen = conn->gather(conn->send_iov, SEND_IOV_MAX);
+
+    io_uring_sqe* sqe = conn->shard->ring->get_sqe();
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = conn->fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&conn->send_msg);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = reinterpret_cast<uint64_t>(conn.get()) | URING_SEND;
+    conn->send_inflight = true;
+}
+
+void HTTPServer::uring_watch_hangup(const std::shared_ptr<Connection>& conn) {
+    // Stays armed across requests until the peer hangs up.
+    if (conn->hangup_poll_inflight) return;
+    io_uring_sqe* sqe = conn->shard->ring->get_sqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = conn->fd;
+    sqe->poll32_events = POLLERR | POLLHUP;
+    sqe->user_data = reinterpret_cast<uint64_t>(conn.get()) | URING_HANGUP;
+    conn->hangup_poll_inflight = true;
+}
+
+void HTTPServer::uring_release_buffer(const std::shared_ptr<Connection>& conn) {
+    if (conn->buffer_slot < 0) return;
+    Shard& shard = *conn->shard;
+    shard.ring->set_buffer(conn->buffer_slot, nullptr, 0);
+    shard.free_buffer_slots.push_back(conn->buffer_slot);
+    conn->buffer_slot = -1;
+    conn->buffer_base = nullptr;
+}
+
+#else
+
+bool HTTPServer::setup_uring(Shard& shard) {
+    std::cerr << "HTTP shard " << shard.index << ": built without io_uring, using epoll" << std::endl;
+    return false;
+}
+void HTTPServer::run_uring_loop(Shard&) {}
+void HTTPServer::uring_complete(Shard&, uint64_t, int) {}
+void HTTPServer::uring_accept(Shard&, int) {}
+void HTTPServer::uring_read_wake(Shard&) {}
+void HTTPServer::uring_recv(const std::shared_ptr<Connection>&) {}
+void HTTPServer::uring_send(const std::shared_ptr<Connection>&) {}
+void HTTPServer::uring_watch_hangup(const std::shared_ptr<Connection>&) {}
+void HTTPServer::uring_release_buffer(const std::shared_ptr<Connection>&) {}
+
+#endif
+
+void HTTPServer::add_route(std::string_view method, std::string_view pattern, const Route& route) {
+    router_.add(method, pattern, static_cast<uint32_t>(routes_.size()));
+    routes_.push_back(route);
+    routes_.back().name.append(method).append(" ").append(pattern);
+}
+
+// Which parts of each search hit go into a response, from the fields=
+// query parameter: a comma-separated list of "values", "metadata" and
+// "metadata.<key>". Id and score are always sent.
+struct HTTPServer::ResultFields {
+    bool values = false;
+    bool metadata = false;
+    // Limits metadata to these keys when not empty.
+    std::vector<std::string> metadata_keys;
+
+    // `fallback` applies when the request has no fields= parameter.
+    static ResultFields from(const HTTPRequest& request, ResultFields fallback) {
+        auto param = request.query_param("fields");
+        if (!param) return fallback;
+
+        ResultFields fields;
+        bool all_metadata = false;
+        std::string_view list = *param;
+        while (!list.empty()) {
+            size_t comma = list.find(',');
+            std::string_view name = list.substr(0, comma);
+            list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+
+            if (name == "values") {
+                fields.values = true;
+            } else if (name == "metadata") {
+                all_metadata = true;
+            } else if (name.starts_with("metadata.")) {
+                fields.metadata_keys.emplace_back(name.substr(9));
+            }
+        }
+        fields.metadata = all_metadata || !fields.metadata_keys.empty();
+        if (all_metadata) fields.metadata_keys.clear();
+        return fields;
     }
 
-    if (action == "stats") {
-        if (method == "GET") return handle_namespace_stats(tenant_id, ns);
+    void write(json::Writer& w, const HNSWResult& r) const {
+        w.raw("{\"id\":").string(r.id).raw(",\"score\":").number(r.distance);
+        if (r.data) {
+            if (values) {
+                w.raw(",\"values\":").float_array(r.values.data(), r.values.size());
+            }
+            if (metadata && metadata_keys.empty()) {
+                w.raw(",\"metadata\":").string_map(r.data->metadata);
+            } else if (metadata) {
+                w.raw(",\"metadata\":{");
+                bool first = true;
+                for (const auto& key : metadata_keys) {
+                    auto it = r.data->metadata.find(key);
+                    if (it == r.data->metadata.end()) continue;
+                    if (!first) w.raw(',');
+                    w.string(key).raw(':').string(it->second);
+                    first = false;
+                }
+                w.raw('}');
+            }
+        }
+        w.raw('}');
+    }
+};
+
+// Every endpoint, in one table. Handlers are captureless lambdas, so a route
+// costs a plain function call once matched.
+void HTTPServer::build_routes() {
+    using Server = HTTPServer;
+    using Context = const RouteContext&;
+    constexpr auto NONE = RouteScope::None;
+    constexpr auto PARAM = RouteScope::Param;
+    constexpr auto BODY_NAME = RouteScope::BodyName;
+
+    add_route("GET", "/health", {[](Server& s, Context) { return s.handle_health(); },
+                                 nullptr, NONE, false, false, true});
+    add_route("GET", "/admission", {[](Server& s, Context) { return s.handle_admission_stats(); },
+                                    nullptr, NONE, false, false, true});
+    add_route("GET", "/shards", {[](Server& s, Context) { return s.handle_shard_stats(); },
+                                 nullptr, NONE, false, false, true});
+    add_route("GET", "/latency", {[](Server& s, Context) { return s.handle_latency_stats(std::nullopt); },
+                                  nullptr, NONE, false, false, true});
+    add_route("GET", "/latency/:name", {[](Server& s, Context c) {
+        return s.handle_latency_stats(c.params[0]);
+    }, nullptr, NONE, false, false, true});
+
+    add_route("GET", "/collections", {[](Server& s, Context) { return s.handle_list_collections(); },
+                                      nullptr, NONE});
+    add_route("POST", "/collections", {[](Server& s, Context c) { return s.handle_create_collection(c.body); },
+                                       nullptr, BODY_NAME});
+    add_route("GET", "/collections/:name", {[](Server& s, Context c) {
+        return s.handle_stats(std::string(c.params[0]));
+    }, nullptr, PARAM});
+    add_route("DELETE", "/collections/:name", {[](Server& s, Context c) {
+        return s.handle_delete_collection(std::string(c.params[0]));
+    }, nullptr, PARAM});
+    // NDJSON, usually not all here yet when the handler starts.
+    add_route("POST", "/collections/:name/ingest", {[](Server& s, Context c) {
+        return s.handle_ingest(std::string(c.params[0]), c.request);
+    }, nullptr, PARAM, true, true});
+
+    add_route("POST", "/search", {[](Server& s, Context c) {
+        return s.handle_search(c.body, ResultFields::from(c.request, {.metadata = true}),
+                               c.request.deadline);
+    }, [](Server& s, Context c) {
+        return s.handle_binary_search(c.request.body, false, c.request.deadline);
+    }});
+    add_route("POST", "/batch_search", {[](Server& s, Context c) {
+        return s.handle_batch_search(c.body, ResultFields::from(c.request, {}), c.request.deadline);
+    }, [](Server& s, Context c) {
+        return s.handle_binary_search(c.request.body, true, c.request.deadline);
+    }});
+    add_route("POST", "/search_with_filter", {[](Server& s, Context c) {
+        return s.handle_search_with_filter(c.body, ResultFields::from(c.request, {.metadata = true}),
+                                           c.request.deadline);
+    }});
+    add_route("POST", "/insert", {[](Server& s, Context c) { return s.handle_insert(c.body); },
+                                  [](Server& s, Context c) { return s.handle_binary_insert(c.request.body, false); }});
+    add_route("POST", "/batch_insert", {[](Server& s, Context c) { return s.handle_batch_insert(c.body); },
+                                        [](Server& s, Context c) { return s.handle_binary_insert(c.request.body, true); }});
+    add_route("POST", "/save", {[](Server& s, Context c) { return s.handle_save(c.body["collection"].string()); }});
+    add_route("POST", "/save_all", {[](Server& s, Context) { return s.handle_save(""); }, nullptr, NONE});
+
+    add_route("GET", "/stats/:name", {[](Server& s, Context c) {
+        return s.handle_stats(std::string(c.params[0]));
+    }, nullptr, PARAM});
+    add_route("GET", "/index/:name", {[](Server& s, Context c) {
+        return s.handle_index_stats(std::string(c.params[0]));
+    }, nullptr, PARAM});
+    add_route("GET", "/count/:name", {[](Server& s, Context c) {
+        return s.handle_count(std::string(c.params[0]));
+    }, nullptr, PARAM});
+
+    add_route("GET", "/vectors/:collection/*id", {[](Server& s, Context c) {
+        return s.handle_get_vector(std::string(c.params[0]), std::string(c.params[1]));
+    }, nullptr, PARAM});
+    add_route("PUT", "/vectors/:collection/*id", {[](Server& s, Context c) {
+        return s.handle_update_vector(std::string(c.params[0]), std::string(c.params[1]), c.body);
+    }, nullptr, PARAM});
+    add_route("DELETE", "/vectors/:collection/*id", {[](Server& s, Context c) {
+        return s.handle_delete_vector(std::string(c.params[0]), std::string(c.params[1]));
+    }, nullptr, PARAM});
+
+    add_route("GET", "/tenants/:tenant/namespaces", {[](Server& s, Context c) {
+        return s.handle_list_namespaces(std::string(c.params[0]));
+    }, nullptr, PARAM});
+    add_route("POST", "/tenants/:tenant/namespaces", {[](Server& s, Context c) {
+        return s.handle_create_namespace(std::string(c.params[0]), c.body);
+    }, nullptr, PARAM});
+    add_route("POST", "/tenants/:tenant/search", {[](Server& s, Context c) {
+        return s.handle_tenant_search(std::string(c.params[0]), c.body, c.request.deadline);
+    }, nullptr, PARAM});
+    add_route("GET", "/tenants/:tenant/stats", {[](Server& s, Context c) {
+        return s.handle_tenant_stats(std::string(c.params[0]));
+    }, nullptr, PARAM});
+
+    add_route("POST", "/tenants/:tenant/:ns/faq", {[](Server& s, Context c) {
+        return s.handle_add_faq(std::string(c.params[0]), std::string(c.params[1]), c.body);
+    }, nullptr, PARAM});
+    add_route("POST", "/tenants/:tenant/:ns/faq/bulk", {[](Server& s, Context c) {
+        return s.handle_bulk_faq(std::string(c.params[0]), std::string(c.params[1]), c.body);
+    }, nullptr, PARAM});
+    add_route("GET", "/tenants/:tenant/:ns/faq/*id", {[](Server& s, Context c) {
+        return s.handle_get_faq(std::string(c.params[0]), std::string(c.params[1]), std::string(c.params[2]));
+    }, nullptr, PARAM});
+    add_route("PUT", "/tenants/:tenant/:ns/faq/*id", {[](Server& s, Context c) {
+        return s.handle_update_faq(std::string(c.params[0]), std::string(c.params[1]),
+                                   std::string(c.params[2]), c.body);
+    }, nullptr, PARAM});
+    add_route("DELETE", "/tenants/:tenant/:ns/faq/*id", {[](Server& s, Context c) {
+        return s.handle_delete_faq(std::string(c.params[0]), std::string(c.params[1]), std::string(c.params[2]));
+    }, nullptr, PARAM});
+    add_route("POST", "/tenants/:tenant/:ns/search", {[](Server& s, Context c) {
+        return s.handle_namespace_search(std::string(c.params[0]), std::string(c.params[1]), c.body,
+                                         c.request.deadline);
+    }, nullptr, PARAM});
+    add_route("GET", "/tenants/:tenant/:ns/stats", {[](Server& s, Context c) {
+        return s.handle_namespace_stats(std::string(c.params[0]), std::string(c.params[1]));
+    }, nullptr, PARAM});
+}
+
+const HTTPServer::Route* HTTPServer::find_route(const HTTPRequest& request, RouteParams& params) const {
+    uint32_t id = router_.match(request.method, request.path, params);
+    return id == HTTPRouter::NO_ROUTE ? nullptr : &routes_[id];
+}
+
+HTTPResponse HTTPServer::handle_request(HTTPRequest& request,
+                                        AdmissionController::Ticket& ticket,
+                                        std::string& collection_name) {
+    try {
+        // Work that waited in the queue past its deadline is dropped unstarted.
+        request.deadline.check();
+
+        RouteParams params;
+        const Route* route = find_route(request, params);
+        if (!route) {
+            return error_response(404, "Not found");
+        }
+
+        HTTPResponse decode_error;
+        if (!decode_body(request, *route, decode_error)) {
+            return decode_error;
+        }
+
+        const auto* content_type = request.header("Content-Type");
+        bool binary_body = route->binary_handler && content_type &&
+                           content_type->rfind(binary::CONTENT_TYPE, 0) == 0;
+
+        // Every JSON body is tokenized once here; handlers read fields from
+        // the document instead of rescanning the text.
+        json::Document document;
+        if (!binary_body && !route->raw_body && !request.body.empty() &&
+            !document.parse(request.body)) {
+            return error_response(400, "Invalid JSON: " + document.error());
+        }
+        json::Value body = document.root();
+
+        // Tenant limits apply once the collection is known, before any real work.
+        std::string_view collection;
+        switch (route->scope) {
+            case RouteScope::None:
+                break;
+            case RouteScope::Param:
+                collection = params[0];
+                break;
+            case RouteScope::BodyName:
+                collection = body["name"].string_view();
+                break;
+            case RouteScope::BodyCollection:
+                collection = binary_body ? binary::peek_collection(request.body)
+                                         : body["collection"].string_view();
+                break;
+        }
+        collection_name = collection;
+        AdmissionController::Rejection rejection;
+        if (!admission_->admit_tenant(ticket, collection, rejection)) {
+            return rejection_response(rejection, collection);
+        }
+
+        RouteContext context{request, body, params};
+        return binary_body ? route->binary_handler(*this, context) : route->handler(*this, context);
+
+    } catch (const DeadlineExceeded& e) {
+        return error_response(504, e.what());
+    } catch (const std::exception& e) {
+        return error_response(500, e.what());
     }
+}
 
-    if (action.rfind("faq/", 0) == 0) {
-        std::string faq_id = action.substr(4);
-        if (method == "GET") return handle_get_faq(tenant_id, ns, faq_id);
-        if (method == "PUT") return handle_update_faq(tenant_id, ns, faq_id, body);
-        if (method == "DELETE") return handle_delete_faq(tenant_id, ns, faq_id);
+bool HTTPServer::decode_body(HTTPRequest& request, const Route& route, HTTPResponse& error) {
+    const auto* header = request.header("Content-Encoding");
+    if (!header) return true;
+
+    compression::Encoding encoding;
+    if (!compression::parse_encoding(*header, encoding)) {
+        error = error_response(415, "Unsupported Content-Encoding: " + *header);
+        return false;
+    }
+    auto decoder = compression::Decoder::create(encoding);
+    if (!decoder) return true;
+
+    // A streamed upload is decoded as the handler reads it.
+    if (route.streamed_upload) {
+        request.body_reader = std::make_unique<DecodingReader>(
+            std::move(decoder), request.body, std::move(request.body_reader));
+        request.body = {};
+        return true;
+    }
+
+    // The JSON parser tokenizes a complete document in place, so any other
+    // body is inflated whole before parsing rather than streamed into it.
+    // Compressed bodies are small next to what they expand to, so grow the
+    // output geometrically instead of guessing its size.
+    size_t limit = std::min(MAX_DECODED_BODY,
+                            std::max(MIN_DECODED_LIMIT, request.body.size() * MAX_DECODE_RATIO));
+    ByteBuffer decoded;
+    decoded.reserve(std::min(limit, std::max(READ_CHUNK_SIZE, request.body.size() * 4)));
+    std::string_view input = request.body;
+    while (!decoder->finished()) {
+        if (decoded.available() == 0) {
+            if (decoded.capacity() >= limit) {
+                error = error_response(413, "Decoded body exceeds " + std::to_string(limit) + " bytes");
+                return false;
+            }
+            decoded.reserve(std::min(decoded.capacity() * 2, limit));
+        }
+        long n = decoder->decode(input, decoded.tail(), decoded.available());
+        if (n < 0) {
+            error = error_response(400, "Invalid " + std::string(compression::name(encoding)) +
+                                        " body: " + decoder->error());
+            return false;
+        }
+        if (n == 0 && !decoder->finished() && decoded.available() > 0) {
+            error = error_response(400, "Truncated " + std::string(compression::name(encoding)) +
+                                        " body");
+            return false;
+        }
+        decoded.commit(n);
+    }
+    if (!input.empty()) {
+        error = error_response(400, "Trailing data after compressed body");
+        return false;
     }
 
-    return error_response(404, "Not found");
+    request.buffer = std::move(decoded);
+    request.body = request.buffer.view(0, request.buffer.size());
+    return true;
+}
+
+void HTTPServer::encode_response(const HTTPRequest& request, HTTPResponse& response) {
+    const auto* accept = request.header("Accept-Encoding");
+    if (!accept) return;
+    // Packed floats barely compress; the JSON and NDJSON responses shrink
+    // several times over.
+    if (response.content_type.rfind(binary::CONTENT_TYPE, 0) == 0) return;
+    if (!response.stream && response.body.size() < MIN_COMPRESSED_RESPONSE) return;
+
+    compression::Encoding encoding = compression::negotiate(*accept);
+    if (encoding == compression::Encoding::Identity) return;
+
+    response.content_encoding = encoding;
+    if (!response.stream) {
+        response.body = compression::compress(encoding, response.body);
+    }
 }
 
-std::string HTTPServer::handle_health() {
+HTTPResponse HTTPServer::handle_health() {
     return json_response(200, R"({"healthy":true,"version":"1.0.0"})");
 }
 
-std::string HTTPServer::handle_list_collections() {
+HTTPResponse HTTPServer::handle_admission_stats() {
+    auto stats = admission_->stats();
+
+    json::Writer w;
+    w.raw("{\"pending\":").number(stats.pending)
+     .raw(",\"max_pending\":").number(stats.max_pending)
+     .raw(",\"max_tenant_in_flight\":").number(stats.max_tenant_in_flight)
+     .raw(",\"queue_depth\":").number(workers_->queue_depth())
+     .raw(",\"workers\":").number(workers_->size())
+     .raw(",\"admitted\":").number(stats.admitted)
+     .raw(",\"rejected_overloaded\":").number(stats.rejected_overloaded)
+     .raw(",\"rejected_tenant\":").number(stats.rejected_tenant)
+     .raw(",\"tenants\":[");
+    for (size_t i = 0; i < stats.tenants.size(); ++i) {
+        const auto& tenant = stats.tenants[i];
+        if (i > 0) w.raw(',');
+        w.raw("{\"tenant\":").string(tenant.tenant)
+         .raw(",\"in_flight\":").number(tenant.in_flight)
+         .raw(",\"rejected\":").number(tenant.rejected).raw('}');
+    }
+    w.raw("]}");
+    return json_response(200, w);
+}
+
+HTTPResponse HTTPServer::handle_shard_stats() {
+    json::Writer w;
+    w.raw("{\"shards\":[");
+    auto stats = shard_stats();
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const auto& shard = stats[i];
+        if (i > 0) w.raw(',');
+        w.raw("{\"shard\":").number(shard.shard).raw(",\"cpu\":").number(shard.cpu)
+         .raw(",\"accepted\":").number(shard.accepted).raw(",\"requests\":").number(shard.requests)
+         .raw(",\"open_connections\":").number(shard.open_connections).raw('}');
+    }
+    w.raw("]}");
+    return json_response(200, w);
+}
+
+// Latency per endpoint, grouped by collection; requests that name none
+// are listed under "".
+HTTPResponse HTTPServer::handle_latency_stats(std::optional<std::string_view> collection) {
+    auto entries = collection ? metrics_->snapshot(*collection) : metrics_->snapshot();
+
+    json::Writer w;
+    w.raw("{\"collections\":[");
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const auto& entry = entries[i];
+        const auto& latency = entry.latency;
+        bool first_endpoint = i == 0 || entries[i - 1].collection != entry.collection;
+        bool last_endpoint = i + 1 == entries.size() || entries[i + 1].collection != entry.collection;
+        if (first_endpoint) {
+            if (i > 0) w.raw(',');
+            w.raw("{\"collection\":").string(entry.collection).raw(",\"endpoints\":[");
+        } else {
+            w.raw(',');
+        }
+        w.raw("{\"endpoint\":").string(entry.endpoint)
+         .raw(",\"count\":").number(latency.count)
+         .raw(",\"mean_ms\":").number(latency.mean_ms)
+         .raw(",\"p50_ms\":").number(latency.p50_ms)
+         .raw(",\"p95_ms\":").number(latency.p95_ms)
+         .raw(",\"p99_ms\":").number(latency.p99_ms)
+         .raw(",\"p999_ms\":").number(latency.p999_ms)
+         .raw(",\"max_ms\":").number(latency.max_ms).raw('}');
+        if (last_endpoint) w.raw("]}");
+    }
+    w.raw("]}");
+    return json_response(200, w);
+}
+
+HTTPResponse HTTPServer::handle_list_collections() {
     auto names = storage_->list_collections();
 
-    std::ostringstream oss;
-    oss << "{\"collections\":[";
+    json::Writer w;
+    w.raw("{\"collections\":[");
     bool first = true;
     for (const auto& name : names) {
         auto stats = storage_->get_stats(name);
         if (stats) {
-            if (!first) oss << ",";
-            oss << "{\"name\":\"" << name << "\","
-                << "\"dimension\":" << stats->dimension << ","
-                << "\"count\":" << stats->vector_count << ","
-                << "\"metric\":\"" << stats->metric << "\"}";
+            if (!first) w.raw(',');
+            w.raw("{\"name\":").string(name)
+             .raw(",\"dimension\":").number(stats->dimension)
+             .raw(",\"count\":").number(stats->vector_count)
+             .raw(",\"metric\":").string(stats->metric).raw('}');
             first = false;
         }
     }
-    oss << "]}";
+    w.raw("]}");
 
-    return json_response(200, oss.str());
+    return json_response(200, w);
 }
 
-std::string HTTPServer::handle_create_collection(const std::string& body) {
-    std::string name = parse_json_string(body, "name");
-    int dimension = parse_json_int(body, "dimension");
-    std::string metric = parse_json_string(body, "metric");
-    int m = parse_json_int(body, "m", 16);
-    int ef_construction = parse_json_int(body, "ef_construction", 200);
-    int ef_search = parse_json_int(body, "ef_search", 50);
+HTTPResponse HTTPServer::handle_create_collection(const json::Value& body) {
+    std::string name = body["name"].string();
+    int dimension = body["dimension"].get_int();
+    std::string_view metric = body["metric"].string_view();
+    int m = body["m"].get_int(16);
+    int ef_construction = body["ef_construction"].get_int(200);
+    int ef_search = body["ef_search"].get_int(50);
 
     CollectionConfig config;
     config.name = name;
@@ -457,7 +1739,7 @@ std::string HTTPServer::handle_create_collection(const std::string& body) {
     return json_response(400, R"({"success":false,"message":"Collection already exists"})");
 }
 
-std::string HTTPServer::handle_delete_collection(const std::string& name) {
+HTTPResponse HTTPServer::handle_delete_collection(const std::string& name) {
     bool success = storage_->delete_collection(name);
 
     if (success) {
@@ -466,242 +1748,363 @@ std::string HTTPServer::handle_delete_collection(const std::string& name) {
     return json_response(404, R"({"success":false,"message":"Collection not found"})");
 }
 
-std::string HTTPServer::handle_stats(const std::string& collection) {
+HTTPResponse HTTPServer::handle_stats(const std::string& collection) {
     auto stats = storage_->get_stats(collection);
 
     if (stats) {
-        std::ostringstream oss;
-        oss << "{\"total_vectors\":" << stats->vector_count
-            << ",\"memory_usage_bytes\":" << stats->memory_usage
-            << ",\"dimension\":" << stats->dimension
-            << ",\"metric\":\"" << stats->metric << "\"}";
-        return json_response(200, oss.str());
+        json::Writer w;
+        w.raw("{\"total_vectors\":").number(stats->vector_count)
+         .raw(",\"memory_usage_bytes\":").number(stats->memory_usage)
+         .raw(",\"dimension\":").number(stats->dimension)
+         .raw(",\"metric\":").string(stats->metric).raw('}');
+        return json_response(200, w);
     }
     return error_response(404, "Collection not found");
 }
 
-std::string HTTPServer::handle_search(const std::string& body) {
-    std::string collection = parse_json_string(body, "collection");
-    auto query = parse_json_float_array(body, "query");
-    int top_k = parse_json_int(body, "top_k", 10);
+HTTPResponse HTTPServer::handle_search(const json::Value& body, const ResultFields& fields,
+                                       const Deadline& deadline) {
+    std::string collection = body["collection"].string();
+    auto query = body["query"].float_vector();
+    int top_k = body["top_k"].get_int(10);
+    auto filter = metadata_from_json(body["filter"]);
 
     auto start = std::chrono::high_resolution_clock::now();
-    auto results = storage_->search(collection, query, top_k);
+    auto results = storage_->search(collection, query, top_k, 0, deadline, filter, fields.values);
     auto end = std::chrono::high_resolution_clock::now();
     float time_ms = std::chrono::duration<float, std::milli>(end - start).count();
 
-    std::ostringstream oss;
-    oss << "{\"results\":[";
+    json::Writer w;
+    w.raw("{\"results\":[");
     bool first = true;
     for (const auto& r : results) {
-        if (!first) oss << ",";
-        oss << "{\"id\":\"" << r.id << "\",\"score\":" << r.distance;
-        if (r.data) {
-            oss << ",\"metadata\":" << metadata_to_json(r.data->metadata);
-        }
-        oss << "}";
+        if (!first) w.raw(',');
+        fields.write(w, r);
         first = false;
     }
-    oss << "],\"search_time_ms\":" << time_ms << "}";
+    w.raw("],\"search_time_ms\":").number(time_ms).raw('}');
 
-    return json_response(200, oss.str());
+    return json_response(200, w);
 }
 
-std::string HTTPServer::handle_batch_search(const std::string& body) {
-    std::string collection = parse_json_string(body, "collection");
-    int top_k = parse_json_int(body, "top_k", 10);
+HTTPResponse HTTPServer::handle_batch_search(const json::Value& body, const ResultFields& fields,
+                                             const Deadline& deadline) {
+    std::string collection = body["collection"].string();
+    int top_k = body["top_k"].get_int(10);
 
     std::vector<std::vector<float>> queries;
-
-    size_t queries_pos = body.find("\"queries\"");
-    if (queries_pos != std::string::npos) {
-        size_t arr_start = body.find('[', queries_pos);
-        if (arr_start != std::string::npos) {
-            size_t pos = arr_start + 1;
-            while (pos < body.length()) {
-                size_t values_pos = body.find("\"values\"", pos);
-                if (values_pos == std::string::npos) break;
-
-                auto q = parse_json_float_array(body.substr(values_pos), "values");
-                if (!q.empty()) {
-                    queries.push_back(std::move(q));
+    auto query_list = body["queries"];
+    queries.reserve(query_list.size());
+    query_list.for_each_element([&](const json::Value& query) {
+        auto values = query["values"].floats();
+        if (!values.empty()) {
+            queries.emplace_back(values.begin(), values.end());
+        }
+    });
+
+    // Checked up front: once the chunked headers are out the status can't change.
+    if (!storage_->collection_exists(collection)) {
+        return error_response(500, "Collection not found: " + collection);
+    }
+
+    // Results go out block by block as chunks, so neither the server nor the
+    // client waits on (or buffers) the full result set.
+    HTTPResponse response;
+    response.stream = [this, collection = std::move(collection), queries = std::move(queries),
+                       top_k, fields, deadline](ChunkWriter& out) mutable {
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t total = queries.size();
+
+        if (!out.write("{\"results\":[")) return;
+        std::vector<std::vector<float>> block;
+        json::Writer w;
+        for (size_t begin = 0; begin < total; begin += STREAM_QUERY_BLOCK) {
+            size_t end = std::min(total, begin + STREAM_QUERY_BLOCK);
+            block.assign(std::make_move_iterator(queries.begin() + begin),
+                         std::make_move_iterator(queries.begin() + end));
+            auto block_results = storage_->batch_search(collection, block, top_k, 0, deadline, fields.values);
+
+            w.clear();
+            for (size_t i = 0; i < block_results.size(); ++i) {
+                if (begin + i > 0) w.raw(',');
+                w.raw("{\"results\":[");
+                bool first = true;
+                for (const auto& r : block_results[i]) {
+                    if (!first) w.raw(',');
+                    fields.write(w, r);
+                    first = false;
                 }
-
-                size_t next_obj = body.find('}', values_pos);
-                if (next_obj == std::string::npos) break;
-                pos = next_obj + 1;
+                w.raw("]}");
             }
+            if (!out.write(w.view())) return;
         }
+
+        auto end_time = std::chrono::high_resolution_clock::now();
+        float time_ms = std::chrono::duration<float, std::milli>(end_time - start).count();
+        w.clear();
+        w.raw("],\"total_queries\":").number(total)
+         .raw(",\"total_time_ms\":").number(time_ms)
+         .raw(",\"avg_time_per_query_ms\":").number(total == 0 ? 0.0f : time_ms / total).raw('}');
+        out.write(w.view());
+    };
+    return response;
+}
+
+HTTPResponse HTTPServer::handle_binary_search(std::string_view body, bool batch, const Deadline& deadline) {
+    binary::Frame frame;
+    std::string error = binary::decode_request(body, false, frame);
+    if (!error.empty()) {
+        return error_response(400, error);
+    }
+    if (!batch && frame.count != 1) {
+        return error_response(400, "Expected exactly one query vector");
+    }
+    auto dimension = storage_->dimension(frame.collection);
+    if (!dimension) {
+        return error_response(404, "Collection not found: " + frame.collection);
     }
+    if (*dimension != frame.dimension) {
+        return error_response(400, "Dimension mismatch: expected " + std::to_string(*dimension));
+    }
+
+    std::vector<std::vector<float>> queries;
+    queries.reserve(frame.count);
+    for (uint32_t i = 0; i < frame.count; ++i) {
+        queries.push_back(frame.vector(i));
+    }
+    size_t top_k = frame.top_k > 0 ? frame.top_k : 10;
 
     auto start = std::chrono::high_resolution_clock::now();
-    auto all_results = storage_->batch_search(collection, queries, top_k);
+    std::vector<std::vector<HNSWResult>> results;
+    if (batch) {
+        results = storage_->batch_search(frame.collection, queries, top_k, 0, deadline);
+    } else {
+        results.push_back(storage_->search(frame.collection, queries[0], top_k, 0, deadline));
+    }
     auto end_time = std::chrono::high_resolution_clock::now();
     float time_ms = std::chrono::duration<float, std::milli>(end_time - start).count();
 
-    std::ostringstream oss;
-    oss << "{\"results\":[";
-    bool first_batch = true;
-    for (const auto& results : all_results) {
-        if (!first_batch) oss << ",";
-        oss << "{\"results\":[";
-        bool first = true;
-        for (const auto& r : results) {
-            if (!first) oss << ",";
-            oss << "{\"id\":\"" << r.id << "\",\"score\":" << r.distance << "}";
-            first = false;
-        }
-        oss << "]}";
-        first_batch = false;
+    // Batch results carry no metadata, matching the JSON endpoint.
+    HTTPResponse response;
+    response.content_type = binary::CONTENT_TYPE;
+    error = binary::encode_results(results, time_ms, !batch, response.body);
+    if (!error.empty()) {
+        return error_response(500, error);
     }
-    oss << "],\"total_queries\":" << queries.size()
-        << ",\"total_time_ms\":" << time_ms
-        << ",\"avg_time_per_query_ms\":" << (queries.empty() ? 0 : time_ms / queries.size()) << "}";
-
-    return json_response(200, oss.str());
+    return response;
 }
 
-std::string HTTPServer::handle_insert(const std::string& body) {
-    std::string collection = parse_json_string(body, "collection");
-    std::string id;
-    std::vector<float> values;
+HTTPResponse HTTPServer::handle_binary_insert(std::string_view body, bool batch) {
+    binary::Frame frame;
+    std::string error = binary::decode_request(body, true, frame);
+    if (!error.empty()) {
+        return error_response(400, error);
+    }
+    auto dimension = storage_->dimension(frame.collection);
+    if (!dimension) {
+        return error_response(404, "Collection not found: " + frame.collection);
+    }
+    if (*dimension != frame.dimension) {
+        return error_response(400, "Dimension mismatch: expected " + std::to_string(*dimension));
+    }
 
-    size_t vec_pos = body.find("\"vector\"");
-    if (vec_pos != std::string::npos) {
-        size_t brace_pos = body.find('{', vec_pos);
-        if (brace_pos != std::string::npos) {
-            size_t id_pos = body.find("\"id\"", brace_pos);
-            if (id_pos != std::string::npos) {
-                size_t colon = body.find(':', id_pos);
-                if (colon != std::string::npos) {
-                    size_t quote_start = body.find('"', colon);
-                    if (quote_start != std::string::npos) {
-                        size_t quote_end = body.find('"', quote_start + 1);
-                        if (quote_end != std::string::npos) {
-                            id = body.substr(quote_start + 1, quote_end - quote_start - 1);
-                        }
-                    }
-                }
-            }
-            values = parse_json_float_array(body, "values");
+    if (!batch) {
+        if (frame.count != 1) {
+            return error_response(400, "Expected exactly one vector");
         }
+        std::string result_id = storage_->insert(frame.collection, frame.vector(0),
+                                                 frame.ids[0], frame.metadata[0]);
+        json::Writer w;
+        w.raw("{\"success\":true,\"id\":").string(result_id).raw('}');
+        return json_response(200, w);
     }
 
+    std::vector<VectorRecord> vectors(frame.count);
+    for (uint32_t i = 0; i < frame.count; ++i) {
+        vectors[i].id = std::move(frame.ids[i]);
+        vectors[i].values = frame.vector(i);
+        vectors[i].metadata = std::move(frame.metadata[i]);
+    }
+
+    size_t count = storage_->batch_insert(frame.collection, vectors);
+
+    json::Writer w;
+    w.raw("{\"success\":true,\"inserted_count\":").number(count)
+     .raw(",\"total_received\":").number(vectors.size()).raw('}');
+    return json_response(200, w);
+}
+
+HTTPResponse HTTPServer::handle_insert(const json::Value& body) {
+    std::string collection = body["collection"].string();
+    auto vector = body["vector"];
+    std::string id = vector["id"].string();
+    auto values = vector["values"].float_vector();
+
     std::string result_id = storage_->insert(collection, values, id);
 
-    std::ostringstream oss;
-    oss << "{\"success\":true,\"id\":\"" << result_id << "\"}";
-    return json_response(200, oss.str());
+    json::Writer w;
+    w.raw("{\"success\":true,\"id\":").string(result_id).raw('}');
+    return json_response(200, w);
 }
 
-std::string HTTPServer::handle_batch_insert(const std::string& body) {
-    std::string collection = parse_json_string(body, "collection");
-    std::vector<VectorData> vectors;
+HTTPResponse HTTPServer::handle_batch_insert(const json::Value& body) {
+    std::string collection = body["collection"].string();
+    std::vector<VectorRecord> vectors;
 
-    size_t vectors_pos = body.find("\"vectors\"");
-    if (vectors_pos == std::string::npos) {
+    auto items = body["vectors"];
+    if (!items) {
         return error_response(400, "Missing vectors array");
     }
-
-    size_t arr_start = body.find('[', vectors_pos);
-    if (arr_start == std::string::npos) {
+    if (!items.is_array()) {
         return error_response(400, "Invalid vectors format");
     }
 
-    size_t pos = arr_start + 1;
-    size_t body_len = body.length();
+    vectors.reserve(items.size());
+    items.for_each_element([&](const json::Value& item) {
+        VectorRecord v;
+        v.id = item["id"].string();
+        v.values = item["values"].float_vector();
+        v.metadata = metadata_from_json(item["metadata"]);
 
-    while (pos < body_len) {
-        while (pos < body_len && (body[pos] == ' ' || body[pos] == '\n' ||
-               body[pos] == '\r' || body[pos] == '\t' || body[pos] == ',')) {
-            pos++;
+        if (!v.values.empty()) {
+            vectors.push_back(std::move(v));
         }
+    });
 
-        if (pos >= body_len || body[pos] == ']') break;
+    size_t count = storage_->batch_insert(collection, vectors);
 
-        if (body[pos] != '{') {
-            pos++;
-            continue;
-        }
+    json::Writer w;
+    w.raw("{\"success\":true,\"inserted_count\":").number(count)
+     .raw(",\"total_received\":").number(vectors.size()).raw('}');
+    return json_response(200, w);
+}
 
-        size_t obj_start = pos;
-        int brace_count = 1;
-        pos++;
-
-        while (pos < body_len && brace_count > 0) {
-            if (body[pos] == '{') brace_count++;
-            else if (body[pos] == '}') brace_count--;
-            else if (body[pos] == '"') {
-                pos++;
-                while (pos < body_len && body[pos] != '"') {
-                    if (body[pos] == '\\') pos++;
-                    pos++;
-                }
+HTTPResponse HTTPServer::handle_ingest(const std::string& collection, const HTTPRequest& request) {
+    if (!storage_->collection_exists(collection)) {
+        return error_response(404, "Collection not found: " + collection);
+    }
+
+    // One status line per record, written while the upload is still coming
+    // in, then a summary line. Clients that only read once their upload is
+    // done would deadlock against a blocking write, so while the body is
+    // still being read, status lines are held back whenever the connection
+    // is congested.
+    HTTPResponse response;
+    response.content_type = "application/x-ndjson";
+    response.stream = [this, collection, &request](ChunkWriter& out) {
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t inserted = 0;
+        size_t failed = 0;
+        size_t line_number = 0;
+        size_t bytes = request.body.size();
+
+        std::string status;
+        json::Document document;
+        auto ingest_line = [&](std::string_view line) {
+            ++line_number;
+            while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) {
+                line.remove_suffix(1);
             }
-            pos++;
-        }
-
-        if (brace_count == 0) {
-            std::string obj = body.substr(obj_start, pos - obj_start);
-
-            VectorData v;
-
-            size_t id_pos = obj.find("\"id\"");
-            if (id_pos != std::string::npos) {
-                size_t colon = obj.find(':', id_pos);
-                if (colon != std::string::npos) {
-                    size_t q1 = obj.find('"', colon);
-                    if (q1 != std::string::npos) {
-                        size_t q2 = obj.find('"', q1 + 1);
-                        if (q2 != std::string::npos) {
-                            v.id = obj.substr(q1 + 1, q2 - q1 - 1);
-                        }
+            if (line.find_first_not_of(" \t") == std::string_view::npos) return;
+
+            std::string error;
+            std::string id;
+            if (!document.parse(line)) {
+                error = "Invalid JSON: " + document.error();
+            } else {
+                json::Value record = document.root();
+                auto values = record["values"].float_vector();
+                if (values.empty()) {
+                    error = "Missing values array";
+                } else {
+                    try {
+                        id = storage_->insert(collection, values, record["id"].string(),
+                                              metadata_from_json(record["metadata"]));
+                    } catch (const std::exception& e) {
+                        error = e.what();
                     }
                 }
             }
 
-            v.values = parse_json_float_array(obj, "values");
-
-            size_t meta_pos = obj.find("\"metadata\"");
-            if (meta_pos != std::string::npos) {
-                size_t meta_start = obj.find('{', meta_pos);
-                size_t meta_end = obj.find('}', meta_start);
-                if (meta_start != std::string::npos && meta_end != std::string::npos) {
-                    std::string meta_str = obj.substr(meta_start, meta_end - meta_start + 1);
-                    size_t mpos = 1;
-                    while (mpos < meta_str.length()) {
-                        size_t key_start = meta_str.find('"', mpos);
-                        if (key_start == std::string::npos) break;
-                        size_t key_end = meta_str.find('"', key_start + 1);
-                        if (key_end == std::string::npos) break;
-                        std::string key = meta_str.substr(key_start + 1, key_end - key_start - 1);
-
-                        size_t val_start = meta_str.find('"', key_end + 1);
-                        if (val_start == std::string::npos) break;
-                        size_t val_end = meta_str.find('"', val_start + 1);
-                        if (val_end == std::string::npos) break;
-                        std::string val = meta_str.substr(val_start + 1, val_end - val_start - 1);
-
-                        v.metadata[key] = val;
-                        mpos = val_end + 1;
+            json::Writer w(status);
+            w.raw("{\"line\":").number(line_number);
+            if (error.empty()) {
+                ++inserted;
+                w.raw(",\"id\":").string(id).raw(",\"status\":\"ok\"}\n");
+            } else {
+                ++failed;
+                w.raw(",\"status\":\"error\",\"error\":").string(error).raw("}\n");
+            }
+        };
+
+        auto flush_status = [&](bool force) {
+            if (status.empty() || (!force && out.congested())) return true;
+            bool ok = out.write(status);
+            status.clear();
+            return ok;
+        };
+
+        // Bytes of the current line not yet terminated by a newline. An
+        // oversized line is reported once and then skipped up to its newline.
+        std::string pending;
+        bool skipping = false;
+        auto consume = [&](std::string_view data) {
+            while (!data.empty()) {
+                size_t newline = data.find('\n');
+                std::string_view piece = data.substr(0, newline);
+                if (!skipping) {
+                    if (pending.size() + piece.size() > INGEST_MAX_LINE) {
+                        ++line_number;
+                        ++failed;
+                        json::Writer(status)
+                            .raw("{\"line\":").number(line_number)
+                            .raw(",\"status\":\"error\",\"error\":\"Line exceeds ")
+                            .number(INGEST_MAX_LINE).raw(" bytes\"}\n");
+                        pending.clear();
+                        skipping = true;
+                    } else if (newline != std::string_view::npos) {
+                        if (pending.empty()) {
+                            ingest_line(piece);
+                        } else {
+                            pending.append(piece);
+                            ingest_line(pending);
+                            pending.clear();
+                        }
+                    } else {
+                        pending.append(piece);
                     }
                 }
+                if (newline == std::string_view::npos) return;
+                skipping = false;
+                data.remove_prefix(newline + 1);
             }
-
-            if (!v.values.empty()) {
-                vectors.push_back(std::move(v));
+        };
+
+        consume(request.body);
+        if (request.body_reader) {
+            std::unique_ptr<char[]> chunk(new char[INGEST_READ_SIZE]);
+            while (request.body_reader->remaining() > 0) {
+                long n = request.body_reader->read(chunk.get(), INGEST_READ_SIZE);
+                if (n <= 0) return;
+                bytes += n;
+                consume(std::string_view(chunk.get(), n));
+                if (!flush_status(false)) return;
             }
         }
-    }
-
-    size_t count = storage_->batch_insert(collection, vectors);
-
-    std::ostringstream oss;
-    oss << "{\"success\":true,\"inserted_count\":" << count << ",\"total_received\":" << vectors.size() << "}";
-    return json_response(200, oss.str());
+        if (!skipping && !pending.empty()) ingest_line(pending);
+        if (!flush_status(true)) return;
+
+        auto end_time = std::chrono::high_resolution_clock::now();
+        float time_ms = std::chrono::duration<float, std::milli>(end_time - start).count();
+        json::Writer w;
+        w.raw("{\"done\":true,\"inserted\":").number(inserted).raw(",\"failed\":").number(failed)
+         .raw(",\"bytes\":").number(bytes).raw(",\"time_ms\":").number(time_ms).raw("}\n");
+        out.write(w.view());
+    };
+    return response;
 }
 
-std::string HTTPServer::handle_delete_vector(const std::string& collection, const std::string& id) {
+HTTPResponse HTTPServer::handle_delete_vector(const std::string& collection, const std::string& id) {
     bool success = storage_->remove(collection, id);
 
     if (success) {
@@ -710,49 +2113,26 @@ std::string HTTPServer::handle_delete_vector(const std::string& collection, cons
     return json_response(404, R"({"success":false,"message":"Vector not found"})");
 }
 
-std::string HTTPServer::handle_get_vector(const std::string& collection, const std::string& id) {
+HTTPResponse HTTPServer::handle_get_vector(const std::string& collection, const std::string& id) {
     auto* data = storage_->get(collection, id);
+    std::vector<float> values;
 
-    if (data) {
-        std::ostringstream oss;
-        oss << "{\"id\":\"" << data->id << "\",\"values\":" << float_array_to_json(data->values)
-            << ",\"metadata\":" << metadata_to_json(data->metadata) << "}";
-        return json_response(200, oss.str());
+    if (data && storage_->get_values(collection, id, values)) {
+        json::Writer w;
+        w.raw("{\"id\":").string(data->id)
+         .raw(",\"values\":").float_array(values.data(), values.size())
+         .raw(",\"metadata\":").string_map(data->metadata).raw('}');
+        return json_response(200, w);
     }
     return error_response(404, "Vector not found");
 }
 
-std::string HTTPServer::handle_update_vector(const std::string& collection,
+HTTPResponse HTTPServer::handle_update_vector(const std::string& collection,
                                               const std::string& id,
-                                              const std::string& body) {
-    auto values = parse_json_float_array(body, "values");
+                                              const json::Value& body) {
+    auto values = body["values"].float_vector();
 
-    std::unordered_map<std::string, std::string> metadata;
-    size_t meta_pos = body.find("\"metadata\"");
-    if (meta_pos != std::string::npos) {
-        size_t meta_start = body.find('{', meta_pos);
-        size_t meta_end = body.find('}', meta_start);
-        if (meta_start != std::string::npos && meta_end != std::string::npos) {
-            std::string meta_str = body.substr(meta_start, meta_end - meta_start + 1);
-            size_t mpos = 1;
-            while (mpos < meta_str.length()) {
-                size_t key_start = meta_str.find('"', mpos);
-                if (key_start == std::string::npos) break;
-                size_t key_end = meta_str.find('"', key_start + 1);
-                if (key_end == std::string::npos) break;
-                std::string key = meta_str.substr(key_start + 1, key_end - key_start - 1);
-
-                size_t val_start = meta_str.find('"', key_end + 1);
-                if (val_start == std::string::npos) break;
-                size_t val_end = meta_str.find('"', val_start + 1);
-                if (val_end == std::string::npos) break;
-                std::string val = meta_str.substr(val_start + 1, val_end - val_start - 1);
-
-                metadata[key] = val;
-                mpos = val_end + 1;
-            }
-        }
-    }
+    auto metadata = metadata_from_json(body["metadata"]);
 
     bool removed = storage_->remove(collection, id);
     if (!removed) {
@@ -761,109 +2141,58 @@ std::string HTTPServer::handle_update_vector(const std::string& collection,
 
     std::string new_id = storage_->insert(collection, values, id, metadata);
 
-    std::ostringstream oss;
-    oss << "{\"success\":true,\"id\":\"" << new_id << "\"}";
-    return json_response(200, oss.str());
-}
-
-std::string HTTPServer::handle_search_with_filter(const std::string& body) {
-    std::string collection = parse_json_string(body, "collection");
-    auto query = parse_json_float_array(body, "query");
-    int top_k = parse_json_int(body, "top_k", 10);
-    int ef = parse_json_int(body, "ef", 0);
-
-    std::unordered_map<std::string, std::string> filters;
-    size_t filter_pos = body.find("\"filter\"");
-    if (filter_pos != std::string::npos) {
-        size_t filter_start = body.find('{', filter_pos);
-        size_t filter_end = body.find('}', filter_start);
-        if (filter_start != std::string::npos && filter_end != std::string::npos) {
-            std::string filter_str = body.substr(filter_start, filter_end - filter_start + 1);
-            size_t fpos = 1;
-            while (fpos < filter_str.length()) {
-                size_t key_start = filter_str.find('"', fpos);
-                if (key_start == std::string::npos) break;
-                size_t key_end = filter_str.find('"', key_start + 1);
-                if (key_end == std::string::npos) break;
-                std::string key = filter_str.substr(key_start + 1, key_end - key_start - 1);
-
-                size_t val_start = filter_str.find('"', key_end + 1);
-                if (val_start == std::string::npos) break;
-                size_t val_end = filter_str.find('"', val_start + 1);
-                if (val_end == std::string::npos) break;
-                std::string val = filter_str.substr(val_start + 1, val_end - val_start - 1);
-
-                filters[key] = val;
-                fpos = val_end + 1;
-            }
-        }
-    }
+    json::Writer w;
+    w.raw("{\"success\":true,\"id\":").string(new_id).raw('}');
+    return json_response(200, w);
+}
+
+HTTPResponse HTTPServer::handle_search_with_filter(const json::Value& body, const ResultFields& fields,
+                                                   const Deadline& deadline) {
+    std::string collection = body["collection"].string();
+    auto query = body["query"].float_vector();
+    int top_k = body["top_k"].get_int(10);
+    int ef = body["ef"].get_int(0);
+    auto filter = metadata_from_json(body["filter"]);
 
     auto start = std::chrono::high_resolution_clock::now();
-    auto results = storage_->search(collection, query, top_k * 3, ef);
+    auto results = storage_->search(collection, query, top_k, ef, deadline, filter, fields.values);
     auto end_time = std::chrono::high_resolution_clock::now();
     float time_ms = std::chrono::duration<float, std::milli>(end_time - start).count();
 
-    std::vector<HNSWResult> filtered;
-    for (const auto& r : results) {
-        if (filtered.size() >= static_cast<size_t>(top_k)) break;
-
-        if (filters.empty()) {
-            filtered.push_back(r);
-            continue;
-        }
-
-        if (r.data) {
-            bool match_all = true;
-            for (const auto& [fk, fv] : filters) {
-                auto it = r.data->metadata.find(fk);
-                if (it == r.data->metadata.end() || it->second != fv) {
-                    match_all = false;
-                    break;
-                }
-            }
-            if (match_all) {
-                filtered.push_back(r);
-            }
-        }
-    }
-
-    std::ostringstream oss;
-    oss << "{\"results\":[";
+    json::Writer w;
+    w.raw("{\"results\":[");
     bool first = true;
-    for (const auto& r : filtered) {
-        if (!first) oss << ",";
-        oss << "{\"id\":\"" << r.id << "\",\"score\":" << r.distance;
-        if (r.data) {
-            oss << ",\"metadata\":" << metadata_to_json(r.data->metadata);
-        }
-        oss << "}";
+    for (const auto& r : results) {
+        if (!first) w.raw(',');
+        fields.write(w, r);
         first = false;
     }
-    oss << "],\"search_time_ms\":" << time_ms << ",\"total_candidates\":" << results.size() << "}";
+    w.raw("],\"search_time_ms\":").number(time_ms)
+     .raw(",\"total_candidates\":").number(results.size()).raw('}');
 
-    return json_response(200, oss.str());
+    return json_response(200, w);
 }
 
-std::string HTTPServer::handle_index_stats(const std::string& collection) {
+HTTPResponse HTTPServer::handle_index_stats(const std::string& collection) {
     auto stats = storage_->get_stats(collection);
 
     if (stats) {
-        std::ostringstream oss;
-        oss << "{\"collection\":\"" << collection << "\","
-            << "\"total_vectors\":" << stats->vector_count << ","
-            << "\"dimension\":" << stats->dimension << ","
-            << "\"memory_usage_bytes\":" << stats->memory_usage << ","
-            << "\"memory_usage_mb\":" << (stats->memory_usage / (1024.0 * 1024.0)) << ","
-            << "\"metric\":\"" << stats->metric << "\","
-            << "\"bytes_per_vector\":" << (stats->vector_count > 0 ? stats->memory_usage / stats->vector_count : 0)
-            << "}";
-        return json_response(200, oss.str());
+        json::Writer w;
+        w.raw("{\"collection\":").string(collection)
+         .raw(",\"total_vectors\":").number(stats->vector_count)
+         .raw(",\"dimension\":").number(stats->dimension)
+         .raw(",\"memory_usage_bytes\":").number(stats->memory_usage)
+         .raw(",\"memory_usage_mb\":").number(stats->memory_usage / (1024.0f * 1024.0f))
+         .raw(",\"metric\":").string(stats->metric)
+         .raw(",\"bytes_per_vector\":")
+         .number(stats->vector_count > 0 ? stats->memory_usage / stats->vector_count : 0)
+         .raw('}');
+        return json_response(200, w);
     }
     return error_response(404, "Collection not found");
 }
 
-std::string HTTPServer::handle_save(const std::string& collection) {
+HTTPResponse HTTPServer::handle_save(const std::string& collection) {
     if (collection.empty()) {
         bool success = storage_->save_all();
         if (success) {
@@ -879,54 +2208,53 @@ std::string HTTPServer::handle_save(const std::string& collection) {
 
     bool success = storage_->save_all();
     if (success) {
-        std::ostringstream oss;
-        oss << "{\"success\":true,\"collection\":\"" << collection << "\"}";
-        return json_response(200, oss.str());
+        json::Writer w;
+        w.raw("{\"success\":true,\"collection\":").string(collection).raw('}');
+        return json_response(200, w);
     }
     return error_response(500, "Failed to save collection");
 }
 
-std::string HTTPServer::handle_count(const std::string& collection) {
+HTTPResponse HTTPServer::handle_count(const std::string& collection) {
     auto stats = storage_->get_stats(collection);
 
     if (stats) {
-        std::ostringstream oss;
-        oss << "{\"collection\":\"" << collection << "\",\"count\":" << stats->vector_count << "}";
-        return json_response(200, oss.str());
+        json::Writer w;
+        w.raw("{\"collection\":").string(collection).raw(",\"count\":").number(stats->vector_count).raw('}');
+        return json_response(200, w);
     }
     return error_response(404, "Collection not found");
 }
 
-std::string HTTPServer::handle_list_namespaces(const std::string& tenant_id) {
+HTTPResponse HTTPServer::handle_list_namespaces(const std::string& tenant_id) {
     auto collections = storage_->list_collections();
     std::string prefix = tenant_id + "__";
 
-    std::ostringstream oss;
-    oss << "{\"tenant_id\":\"" << tenant_id << "\",\"namespaces\":[";
+    json::Writer w;
+    w.raw("{\"tenant_id\":").string(tenant_id).raw(",\"namespaces\":[");
     bool first = true;
     for (const auto& col : collections) {
         if (col.rfind(prefix, 0) == 0) {
-            if (!first) oss << ",";
-            std::string ns = col.substr(prefix.length());
+            if (!first) w.raw(',');
+            std::string_view ns = std::string_view(col).substr(prefix.length());
             auto stats = storage_->get_stats(col);
-            oss << "{\"name\":\"" << ns << "\"";
+            w.raw("{\"name\":").string(ns);
             if (stats) {
-                oss << ",\"vector_count\":" << stats->vector_count;
-                oss << ",\"dimension\":" << stats->dimension;
+                w.raw(",\"vector_count\":").number(stats->vector_count);
+                w.raw(",\"dimension\":").number(stats->dimension);
             }
-            oss << "}";
+            w.raw('}');
             first = false;
         }
     }
-    oss << "]}";
-    return json_response(200, oss.str());
+    w.raw("]}");
+    return json_response(200, w);
 }
 
-std::string HTTPServer::handle_create_namespace(const std::string& tenant_id, const std::string& body) {
-    std::string ns = parse_json_string(body, "namespace");
-    int dimension = parse_json_int(body, "dimension", 384);
-    std::string metric = parse_json_string(body, "metric");
-    if (metric.empty()) metric = "cosine";
+HTTPResponse HTTPServer::handle_create_namespace(const std::string& tenant_id, const json::Value& body) {
+    std::string ns = body["namespace"].string();
+    int dimension = body["dimension"].get_int(384);
+    std::string_view metric = body["metric"].string_view("cosine");
 
     std::string col_name = make_collection_name(tenant_id, ns);
 
@@ -939,27 +2267,27 @@ std::string HTTPServer::handle_create_namespace(const std::string& tenant_id, co
 
     bool success = storage_->create_collection(config);
     if (success) {
-        std::ostringstream oss;
-        oss << "{\"success\":true,\"tenant_id\":\"" << tenant_id
-            << "\",\"namespace\":\"" << ns
-            << "\",\"dimension\":" << dimension << "}";
-        return json_response(201, oss.str());
+        json::Writer w;
+        w.raw("{\"success\":true,\"tenant_id\":").string(tenant_id)
+         .raw(",\"namespace\":").string(ns)
+         .raw(",\"dimension\":").number(dimension).raw('}');
+        return json_response(201, w);
     }
     return error_response(409, "Namespace already exists");
 }
 
-std::string HTTPServer::handle_add_faq(const std::string& tenant_id, const std::string& ns, const std::string& body) {
+HTTPResponse HTTPServer::handle_add_faq(const std::string& tenant_id, const std::string& ns, const json::Value& body) {
     std::string col_name = make_collection_name(tenant_id, ns);
 
     if (!storage_->collection_exists(col_name)) {
         return error_response(404, "Namespace not found");
     }
 
-    std::string faq_id = parse_json_string(body, "id");
-    std::string question = parse_json_string(body, "question");
-    std::string answer = parse_json_string(body, "answer");
-    std::string category = parse_json_string(body, "category");
-    auto values = parse_json_float_array(body, "vector");
+    std::string faq_id = body["id"].string();
+    std::string question = body["question"].string();
+    std::string answer = body["answer"].string();
+    std::string category = body["category"].string();
+    auto values = body["vector"].float_vector();
 
     if (values.empty()) {
         return error_response(400, "Vector is required");
@@ -975,171 +2303,113 @@ std::string HTTPServer::handle_add_faq(const std::string& tenant_id, const std::
 
     std::string result_id = storage_->insert(col_name, values, faq_id, metadata);
 
-    std::ostringstream oss;
-    oss << "{\"success\":true,\"id\":\"" << result_id
-        << "\",\"tenant_id\":\"" << tenant_id
-        << "\",\"namespace\":\"" << ns << "\"}";
-    return json_response(201, oss.str());
+    json::Writer w;
+    w.raw("{\"success\":true,\"id\":").string(result_id)
+     .raw(",\"tenant_id\":").string(tenant_id)
+     .raw(",\"namespace\":").string(ns).raw('}');
+    return json_response(201, w);
 }
 
-std::string HTTPServer::handle_bulk_faq(const std::string& tenant_id, const std::string& ns, const std::string& body) {
+HTTPResponse HTTPServer::handle_bulk_faq(const std::string& tenant_id, const std::string& ns, const json::Value& body) {
     std::string col_name = make_collection_name(tenant_id, ns);
 
     if (!storage_->collection_exists(col_name)) {
         return error_response(404, "Namespace not found");
     }
 
-    std::vector<VectorData> vectors;
-
-    size_t items_pos = body.find("\"items\"");
-    if (items_pos == std::string::npos) {
-        items_pos = body.find('[');
-    } else {
-        items_pos = body.find('[', items_pos);
-    }
-
-    if (items_pos != std::string::npos) {
-        size_t pos = items_pos + 1;
-        while (pos < body.length()) {
-            while (pos < body.length() && (body[pos] == ' ' || body[pos] == '\n' ||
-                   body[pos] == '\r' || body[pos] == '\t' || body[pos] == ',')) {
-                pos++;
-            }
-
-            if (pos >= body.length() || body[pos] == ']') break;
-
-            if (body[pos] != '{') {
-                pos++;
-                continue;
-            }
-
-            size_t obj_start = pos;
-            int brace_count = 1;
-            pos++;
-
-            while (pos < body.length() && brace_count > 0) {
-                if (body[pos] == '{') brace_count++;
-                else if (body[pos] == '}') brace_count--;
-                else if (body[pos] == '"') {
-                    pos++;
-                    while (pos < body.length() && body[pos] != '"') {
-                        if (body[pos] == '\\') pos++;
-                        pos++;
-                    }
-                }
-                pos++;
-            }
-
-            if (brace_count == 0) {
-                std::string item = body.substr(obj_start, pos - obj_start);
-                VectorData v;
-                v.id = parse_json_string(item, "id");
-                v.values = parse_json_float_array(item, "vector");
-                v.metadata["question"] = parse_json_string(item, "question");
-                v.metadata["answer"] = parse_json_string(item, "answer");
-                v.metadata["category"] = parse_json_string(item, "category");
-                v.metadata["type"] = "faq";
-                v.metadata["tenant_id"] = tenant_id;
-                v.metadata["namespace"] = ns;
-
-                if (!v.values.empty()) {
-                    vectors.push_back(std::move(v));
-                }
-            }
+    std::vector<VectorRecord> vectors;
+
+    // Either {"items":[...]} or a bare array of items.
+    auto items = body.is_array() ? body : body["items"];
+    vectors.reserve(items.size());
+    items.for_each_element([&](const json::Value& item) {
+        VectorRecord v;
+        v.id = item["id"].string();
+        v.values = item["vector"].float_vector();
+        v.metadata["question"] = item["question"].string();
+        v.metadata["answer"] = item["answer"].string();
+        v.metadata["category"] = item["category"].string();
+        v.metadata["type"] = "faq";
+        v.metadata["tenant_id"] = tenant_id;
+        v.metadata["namespace"] = ns;
+
+        if (!v.values.empty()) {
+            vectors.push_back(std::move(v));
         }
-    }
+    });
 
     size_t count = storage_->batch_insert(col_name, vectors);
 
-    std::ostringstream oss;
-    oss << "{\"success\":true,\"inserted_count\":" << count
-        << ",\"tenant_id\":\"" << tenant_id
-        << "\",\"namespace\":\"" << ns << "\"}";
-    return json_response(201, oss.str());
+    json::Writer w;
+    w.raw("{\"success\":true,\"inserted_count\":").number(count)
+     .raw(",\"tenant_id\":").string(tenant_id)
+     .raw(",\"namespace\":").string(ns).raw('}');
+    return json_response(201, w);
 }
 
-std::string HTTPServer::handle_namespace_search(const std::string& tenant_id, const std::string& ns, const std::string& body) {
+HTTPResponse HTTPServer::handle_namespace_search(const std::string& tenant_id, const std::string& ns, const json::Value& body,
+                                                const Deadline& deadline) {
     std::string col_name = make_collection_name(tenant_id, ns);
 
     if (!storage_->collection_exists(col_name)) {
         return error_response(404, "Namespace not found");
     }
 
-    auto query = parse_json_float_array(body, "query");
-    int top_k = parse_json_int(body, "top_k", 5);
-    std::string category = parse_json_string(body, "category");
+    auto query = body["query"].float_vector();
+    int top_k = body["top_k"].get_int(5);
+    std::string category = body["category"].string();
+    MetadataFilter filter;
+    if (!category.empty()) filter.emplace("category", category);
 
     auto start = std::chrono::high_resolution_clock::now();
 
-    size_t search_k = category.empty() ? top_k : top_k * 3;
-    auto results = storage_->search(col_name, query, search_k);
+    auto results = storage_->search(col_name, query, top_k, 0, deadline, filter);
 
     auto end_time = std::chrono::high_resolution_clock::now();
     float time_ms = std::chrono::duration<float, std::milli>(end_time - start).count();
 
-    std::ostringstream oss;
-    oss << "{\"results\":[";
+    json::Writer w;
+    w.raw("{\"results\":[");
     bool first = true;
-    int count = 0;
     for (const auto& r : results) {
-        if (count >= top_k) break;
-
-        if (!category.empty() && r.data) {
-            auto cat_it = r.data->metadata.find("category");
-            if (cat_it == r.data->metadata.end() || cat_it->second != category) {
-                continue;
-            }
-        }
-
-        if (!first) oss << ",";
-        oss << "{\"id\":\"" << r.id << "\",\"score\":" << r.distance;
+        if (!first) w.raw(',');
+        w.raw("{\"id\":").string(r.id).raw(",\"score\":").number(r.distance);
         if (r.data) {
             auto q_it = r.data->metadata.find("question");
             auto a_it = r.data->metadata.find("answer");
             auto c_it = r.data->metadata.find("category");
             if (q_it != r.data->metadata.end()) {
-                oss << ",\"question\":\"" << q_it->second << "\"";
+                w.raw(",\"question\":").string(q_it->second);
             }
             if (a_it != r.data->metadata.end()) {
-                oss << ",\"answer\":\"" << a_it->second << "\"";
+                w.raw(",\"answer\":").string(a_it->second);
             }
             if (c_it != r.data->metadata.end()) {
-                oss << ",\"category\":\"" << c_it->second << "\"";
+                w.raw(",\"category\":").string(c_it->second);
             }
         }
-        oss << "}";
+        w.raw('}');
         first = false;
-        count++;
     }
-    oss << "],\"search_time_ms\":" << time_ms
-        << ",\"tenant_id\":\"" << tenant_id
-        << "\",\"namespace\":\"" << ns << "\"}";
+    w.raw("],\"search_time_ms\":").number(time_ms)
+     .raw(",\"tenant_id\":").string(tenant_id)
+     .raw(",\"namespace\":").string(ns).raw('}');
 
-    return json_response(200, oss.str());
+    return json_response(200, w);
 }
 
-std::string HTTPServer::handle_tenant_search(const std::string& tenant_id, const std::string& body) {
-    auto query = parse_json_float_array(body, "query");
-    int top_k = parse_json_int(body, "top_k", 5);
-    std::string category = parse_json_string(body, "category");
+HTTPResponse HTTPServer::handle_tenant_search(const std::string& tenant_id, const json::Value& body,
+                                             const Deadline& deadline) {
+    auto query = body["query"].float_vector();
+    int top_k = body["top_k"].get_int(5);
+    std::string category = body["category"].string();
+    MetadataFilter filter;
+    if (!category.empty()) filter.emplace("category", category);
 
     std::vector<std::string> namespaces;
-    size_t ns_pos = body.find("\"namespaces\"");
-    if (ns_pos != std::string::npos) {
-        size_t arr_start = body.find('[', ns_pos);
-        if (arr_start != std::string::npos) {
-            size_t arr_end = body.find(']', arr_start);
-            std::string ns_str = body.substr(arr_start, arr_end - arr_start);
-            size_t pos = 0;
-            while ((pos = ns_str.find('"', pos)) != std::string::npos) {
-                size_t end = ns_str.find('"', pos + 1);
-                if (end != std::string::npos) {
-                    namespaces.push_back(ns_str.substr(pos + 1, end - pos - 1));
-                    pos = end + 1;
-                } else break;
-            }
-        }
-    }
+    body["namespaces"].for_each_element([&](const json::Value& ns) {
+        if (ns.is_string()) namespaces.emplace_back(ns.string_view());
+    });
 
     if (namespaces.empty()) {
         auto collections = storage_->list_collections();
@@ -1159,7 +2429,8 @@ std::string HTTPServer::handle_tenant_search(const std::string& tenant_id, const
         std::string col_name = make_collection_name(tenant_id, ns);
         if (!storage_->collection_exists(col_name)) continue;
 
-        auto results = storage_->search(col_name, query, top_k * 2);
+        // Each namespace's own top k is enough to make up the overall top k.
+        auto results = storage_->search(col_name, query, top_k, 0, deadline, filter);
         for (const auto& r : results) {
             all_results.emplace_back(r.id, r.distance, r.data);
         }
@@ -1171,52 +2442,45 @@ std::string HTTPServer::handle_tenant_search(const std::string& tenant_id, const
     auto end_time = std::chrono::high_resolution_clock::now();
     float time_ms = std::chrono::duration<float, std::milli>(end_time - start).count();
 
-    std::ostringstream oss;
-    oss << "{\"results\":[";
+    json::Writer w;
+    w.raw("{\"results\":[");
     bool first = true;
     int count = 0;
     for (const auto& [id, score, data] : all_results) {
         if (count >= top_k) break;
 
-        if (!category.empty() && data) {
-            auto cat_it = data->metadata.find("category");
-            if (cat_it == data->metadata.end() || cat_it->second != category) {
-                continue;
-            }
-        }
-
-        if (!first) oss << ",";
-        oss << "{\"id\":\"" << id << "\",\"score\":" << score;
+        if (!first) w.raw(',');
+        w.raw("{\"id\":").string(id).raw(",\"score\":").number(score);
         if (data) {
             auto q_it = data->metadata.find("question");
             auto a_it = data->metadata.find("answer");
             auto c_it = data->metadata.find("category");
             auto ns_it = data->metadata.find("namespace");
             if (q_it != data->metadata.end()) {
-                oss << ",\"question\":\"" << q_it->second << "\"";
+                w.raw(",\"question\":").string(q_it->second);
             }
             if (a_it != data->metadata.end()) {
-                oss << ",\"answer\":\"" << a_it->second << "\"";
+                w.raw(",\"answer\":").string(a_it->second);
             }
             if (c_it != data->metadata.end()) {
-                oss << ",\"category\":\"" << c_it->second << "\"";
+                w.raw(",\"category\":").string(c_it->second);
             }
             if (ns_it != data->metadata.end()) {
-                oss << ",\"namespace\":\"" << ns_it->second << "\"";
+                w.raw(",\"namespace\":").string(ns_it->second);
             }
         }
-        oss << "}";
+        w.raw('}');
         first = false;
         count++;
     }
-    oss << "],\"search_time_ms\":" << time_ms
-        << ",\"tenant_id\":\"" << tenant_id
-        << "\",\"namespaces_searched\":" << namespaces.size() << "}";
+    w.raw("],\"search_time_ms\":").number(time_ms)
+     .raw(",\"tenant_id\":").string(tenant_id)
+     .raw(",\"namespaces_searched\":").number(namespaces.size()).raw('}');
 
-    return json_response(200, oss.str());
+    return json_response(200, w);
 }
 
-std::string HTTPServer::handle_get_faq(const std::string& tenant_id, const std::string& ns, const std::string& faq_id) {
+HTTPResponse HTTPServer::handle_get_faq(const std::string& tenant_id, const std::string& ns, const std::string& faq_id) {
     std::string col_name = make_collection_name(tenant_id, ns);
 
     auto* data = storage_->get(col_name, faq_id);
@@ -1224,24 +2488,28 @@ std::string HTTPServer::handle_get_faq(const std::string& tenant_id, const std::
         return error_response(404, "FAQ not found");
     }
 
-    std::ostringstream oss;
-    oss << "{\"id\":\"" << data->id << "\"";
+    json::Writer w;
+    w.raw("{\"id\":").string(data->id);
 
     auto q_it = data->metadata.find("question");
     auto a_it = data->metadata.find("answer");
     auto c_it = data->metadata.find("category");
 
-    if (q_it != data->metadata.end()) oss << ",\"question\":\"" << q_it->second << "\"";
-    if (a_it != data->metadata.end()) oss << ",\"answer\":\"" << a_it->second << "\"";
-    if (c_it != data->metadata.end()) oss << ",\"category\":\"" << c_it->second << "\"";
+    if (q_it != data->metadata.end()) w.raw(",\"question\":").string(q_it->second);
+    if (a_it != data->metadata.end()) w.raw(",\"answer\":").string(a_it->second);
+    if (c_it != data->metadata.end()) w.raw(",\"category\":").string(c_it->second);
 
-    oss << ",\"vector\":" << float_array_to_json(data->values);
-    oss << ",\"tenant_id\":\"" << tenant_id << "\",\"namespace\":\"" << ns << "\"}";
+    std::vector<float> values;
+    if (!storage_->get_values(col_name, faq_id, values)) {
+        return error_response(404, "FAQ not found");
+    }
+    w.raw(",\"vector\":").float_array(values.data(), values.size());
+    w.raw(",\"tenant_id\":").string(tenant_id).raw(",\"namespace\":").string(ns).raw('}');
 
-    return json_response(200, oss.str());
+    return json_response(200, w);
 }
 
-std::string HTTPServer::handle_delete_faq(const std::string& tenant_id, const std::string& ns, const std::string& faq_id) {
+HTTPResponse HTTPServer::handle_delete_faq(const std::string& tenant_id, const std::string& ns, const std::string& faq_id) {
     std::string col_name = make_collection_name(tenant_id, ns);
 
     bool success = storage_->remove(col_name, faq_id);
@@ -1251,8 +2519,8 @@ std::string HTTPServer::handle_delete_faq(const std::string& tenant_id, const st
     return error_response(404, "FAQ not found");
 }
 
-std::string HTTPServer::handle_update_faq(const std::string& tenant_id, const std::string& ns,
-                                           const std::string& faq_id, const std::string& body) {
+HTTPResponse HTTPServer::handle_update_faq(const std::string& tenant_id, const std::string& ns,
+                                           const std::string& faq_id, const json::Value& body) {
     std::string col_name = make_collection_name(tenant_id, ns);
 
     auto* existing = storage_->get(col_name, faq_id);
@@ -1260,33 +2528,36 @@ std::string HTTPServer::handle_update_faq(const std::string& tenant_id, const st
         return error_response(404, "FAQ not found");
     }
 
-    std::string question = parse_json_string(body, "question");
-    std::string answer = parse_json_string(body, "answer");
-    std::string category = parse_json_string(body, "category");
-    auto values = parse_json_float_array(body, "vector");
+    std::string question = body["question"].string();
+    std::string answer = body["answer"].string();
+    std::string category = body["category"].string();
+    auto values = body["vector"].float_vector();
 
-    if (values.empty()) {
-        values = existing->values;
+    // An update without a vector keeps the stored one; when that can't be
+    // read, fail rather than re-insert the FAQ with an empty vector.
+    if (values.empty() && !storage_->get_values(col_name, faq_id, values)) {
+        return error_response(404, "FAQ not found");
     }
 
+    // Taken before the remove below frees `existing`.
+    std::unordered_map<std::string, std::string> metadata = existing->metadata;
     storage_->remove(col_name, faq_id);
 
-    std::unordered_map<std::string, std::string> metadata;
-    metadata["question"] = question.empty() ? existing->metadata.at("question") : question;
-    metadata["answer"] = answer.empty() ? existing->metadata.at("answer") : answer;
-    metadata["category"] = category.empty() ? existing->metadata.at("category") : category;
+    if (!question.empty()) metadata["question"] = question;
+    if (!answer.empty()) metadata["answer"] = answer;
+    if (!category.empty()) metadata["category"] = category;
     metadata["type"] = "faq";
     metadata["tenant_id"] = tenant_id;
     metadata["namespace"] = ns;
 
     std::string new_id = storage_->insert(col_name, values, faq_id, metadata);
 
-    std::ostringstream oss;
-    oss << "{\"success\":true,\"id\":\"" << new_id << "\"}";
-    return json_response(200, oss.str());
+    json::Writer w;
+    w.raw("{\"success\":true,\"id\":").string(new_id).raw('}');
+    return json_response(200, w);
 }
 
-std::string HTTPServer::handle_namespace_stats(const std::string& tenant_id, const std::string& ns) {
+HTTPResponse HTTPServer::handle_namespace_stats(const std::string& tenant_id, const std::string& ns) {
     std::string col_name = make_collection_name(tenant_id, ns);
     auto stats = storage_->get_stats(col_name);
 
@@ -1294,18 +2565,18 @@ std::string HTTPServer::handle_namespace_stats(const std::string& tenant_id, con
         return error_response(404, "Namespace not found");
     }
 
-    std::ostringstream oss;
-    oss << "{\"tenant_id\":\"" << tenant_id
-        << "\",\"namespace\":\"" << ns
-        << "\",\"vector_count\":" << stats->vector_count
-        << ",\"dimension\":" << stats->dimension
-        << ",\"memory_usage_bytes\":" << stats->memory_usage
-        << ",\"metric\":\"" << stats->metric << "\"}";
+    json::Writer w;
+    w.raw("{\"tenant_id\":").string(tenant_id)
+     .raw(",\"namespace\":").string(ns)
+     .raw(",\"vector_count\":").number(stats->vector_count)
+     .raw(",\"dimension\":").number(stats->dimension)
+     .raw(",\"memory_usage_bytes\":").number(stats->memory_usage)
+     .raw(",\"metric\":").string(stats->metric).raw('}');
 
-    return json_response(200, oss.str());
+    return json_response(200, w);
 }
 
-std::string HTTPServer::handle_tenant_stats(const std::string& tenant_id) {
+HTTPResponse HTTPServer::handle_tenant_stats(const std::string& tenant_id) {
     auto collections = storage_->list_collections();
     std::string prefix = tenant_id + "__";
 
@@ -1313,8 +2584,9 @@ std::string HTTPServer::handle_tenant_stats(const std::string& tenant_id) {
     size_t total_memory = 0;
     int namespace_count = 0;
 
-    std::ostringstream ns_oss;
-    ns_oss << "[";
+    // The totals lead the response, so the namespace list is collected first.
+    json::Writer namespaces;
+    namespaces.raw('[');
     bool first = true;
 
     for (const auto& col : collections) {
@@ -1325,42 +2597,91 @@ std::string HTTPServer::handle_tenant_stats(const std::string& tenant_id) {
                 total_memory += stats->memory_usage;
                 namespace_count++;
 
-                if (!first) ns_oss << ",";
-                std::string ns = col.substr(prefix.length());
-                ns_oss << "{\"name\":\"" << ns
-                       << "\",\"vector_count\":" << stats->vector_count << "}";
+                if (!first) namespaces.raw(',');
+                namespaces.raw("{\"name\":").string(std::string_view(col).substr(prefix.length()))
+                          .raw(",\"vector_count\":").number(stats->vector_count).raw('}');
                 first = false;
             }
         }
     }
-    ns_oss << "]";
+    namespaces.raw(']');
+
+    json::Writer w;
+    w.raw("{\"tenant_id\":").string(tenant_id)
+     .raw(",\"namespace_count\":").number(namespace_count)
+     .raw(",\"total_vectors\":").number(total_vectors)
+     .raw(",\"total_memory_bytes\":").number(total_memory)
+     .raw(",\"namespaces\":").raw(namespaces.view()).raw('}');
+
+    return json_response(200, w);
+}
 
-    std::ostringstream oss;
-    oss << "{\"tenant_id\":\"" << tenant_id
-        << "\",\"namespace_count\":" << namespace_count
-        << ",\"total_vectors\":" << total_vectors
-        << ",\"total_memory_bytes\":" << total_memory
-        << ",\"namespaces\":" << ns_oss.str() << "}";
+HTTPResponse HTTPServer::json_response(int code, std::string body) {
+    HTTPResponse response;
+    response.status = code;
+    response.body = std::move(body);
+    return response;
+}
+
+HTTPResponse HTTPServer::json_response(int code, const json::Writer& body) {
+    // One exact-size copy; the writer's buffer keeps its capacity for the
+    // next response.
+    return json_response(code, std::string(body.view()));
+}
+
+std::string HTTPServer::serialize_head(const HTTPResponse& response, bool keep_alive,
+                                       const HTTPServerConfig& config) {
+    std::string head;
+    head.reserve(256);
+    json::Writer w(head);
+    w.raw("HTTP/1.1 ").number(response.status).raw(' ').raw(status_text(response.status)).raw("\r\n")
+     .raw("Content-Type: ").raw(response.content_type).raw("\r\n");
+    if (response.stream) {
+        w.raw("Transfer-Encoding: chunked\r\n");
+    } else {
+        w.raw("Content-Length: ").number(response.body.size()).raw("\r\n");
+    }
+    if (response.content_encoding != compression::Encoding::Identity) {
+        w.raw("Content-Encoding: ").raw(compression::name(response.content_encoding)).raw("\r\n");
+    }
+    w.raw("Vary: Accept-Encoding\r\n"
+          "Access-Control-Allow-Origin: *\r\n");
+    if (response.status == 503) {
+        w.raw("Retry-After: 1\r\n");
+    }
+    if (keep_alive) {
+        w.raw("Connection: keep-alive\r\n")
+         .raw("Keep-Alive: timeout=").number(config.idle_timeout.count())
+         .raw(", max=").number(config.max_requests_per_connection).raw("\r\n");
+    } else {
+        w.raw("Connection: close\r\n");
+    }
+    w.raw("\r\n");
+    return head;
+}
 
-    return json_response(200, oss.str());
+void HTTPServer::queue_response(const std::shared_ptr<Connection>& conn, HTTPResponse response,
+                                bool keep_alive) {
+    std::string head = serialize_head(response, keep_alive, config_);
+    conn->pending += head.size() + response.body.size();
+    conn->queue(std::move(head));
+    conn->queue(std::move(response.body));
 }
 
-std::string HTTPServer::json_response(int code, const std::string& body) {
-    std::ostringstream oss;
-    oss << "HTTP/1.1 " << code << " OK\r\n"
-        << "Content-Type: application/json\r\n"
-        << "Content-Length: " << body.size() << "\r\n"
-        << "Access-Control-Allow-Origin: *\r\n"
-        << "Connection: close\r\n"
-        << "\r\n"
-        << body;
-    return oss.str();
+HTTPResponse HTTPServer::error_response(int code, const std::string& message) {
+    HTTPResponse response;
+    response.status = code;
+    json::Writer(response.body).raw("{\"error\":").string(message).raw('}');
+    return response;
 }
 
-std::string HTTPServer::error_response(int code, const std::string& message) {
-    std::ostringstream body;
-    body << "{\"error\":\"" << message << "\"}";
-    return json_response(code, body.str());
+HTTPResponse HTTPServer::rejection_response(AdmissionController::Rejection rejection,
+                                            std::string_view collection) {
+    if (rejection == AdmissionController::Rejection::TenantLimit) {
+        return error_response(503, "Too many concurrent requests for tenant " +
+                                   std::string(tenant_of(collection)));
+    }
+    return error_response(503, "Server overloaded");
 }
 
 }
@@ -0,0 +1,202 @@
+#include "io_uring.hpp"
+
+#ifdef VECTORDB_HAVE_IO_URING
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace vectordb {
+
+namespace {
+
+int sys_io_uring_setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+                       const void* arg, size_t arg_size) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                                    arg, arg_size));
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+}
+
+std::unique_ptr<IoUring> IoUring::create(unsigned entries, std::initializer_list<int> required_ops,
+                                         std::string& error) {
+#ifndef IORING_FEAT_EXT_ARG
+    error = "kernel headers predate IORING_FEAT_EXT_ARG";
+    return nullptr;
+#else
+    std::unique_ptr<IoUring> ring(new IoUring());
+
+    io_uring_params params{};
+    // Completions can outnumber submissions (every connection keeps a recv
+    // and a poll outstanding), so give the completion queue extra room.
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = entries * 8;
+    ring->fd_ = sys_io_uring_setup(entries, &params);
+    if (ring->fd_ < 0) {
+        error = std::string("io_uring_setup: ") + std::strerror(errno);
+        return nullptr;
+    }
+    // The wait timeout is passed to io_uring_enter() directly.
+    if (!(params.features & IORING_FEAT_EXT_ARG)) {
+        error = "kernel lacks IORING_FEAT_EXT_ARG";
+        return nullptr;
+    }
+
+    std::vector<char> probe_storage(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op));
+    auto* probe = reinterpret_cast<io_uring_probe*>(probe_storage.data());
+    if (sys_io_uring_register(ring->fd_, IORING_REGISTER_PROBE, probe, 256) < 0) {
+        error = std::string("io_uring probe: ") + std::strerror(errno);
+        return nullptr;
+    }
+    for (int op : required_ops) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            error = "kernel lacks io_uring op " + std::to_string(op);
+            return nullptr;
+        }
+    }
+
+    ring->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        ring->sq_ring_size_ = ring->cq_ring_size_ = std::max(ring->sq_ring_size_, ring->cq_ring_size_);
+    }
+
+    ring->sq_ring_ = mmap(nullptr, ring->sq_ring_size_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring->fd_, IORING_OFF_SQ_RING);
+    if (ring->sq_ring_ == MAP_FAILED) {
+        ring->sq_ring_ = nullptr;
+        error = std::string("mmap: ") + std::strerror(errno);
+        return nullptr;
+    }
+    if (single_mmap) {
+        ring->cq_ring_ = ring->sq_ring_;
+    } else {
+        ring->cq_ring_ = mmap(nullptr, ring->cq_ring_size_, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, ring->fd_, IORING_OFF_CQ_RING);
+        if (ring->cq_ring_ == MAP_FAILED) {
+            ring->cq_ring_ = nullptr;
+            error = std::string("mmap: ") + std::strerror(errno);
+            return nullptr;
+        }
+    }
+    ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        error = std::string("mmap: ") + std::strerror(errno);
+        return nullptr;
+    }
+    ring->sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    auto* sq = static_cast<char*>(ring->sq_ring_);
+    ring->sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    ring->sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    ring->sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    ring->sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    ring->sq_entries_ = params.sq_entries;
+    ring->sqe_tail_ = *ring->sq_tail_;
+
+    auto* cq = static_cast<char*>(ring->cq_ring_);
+    ring->cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    ring->cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    ring->cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    ring->cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    return ring;
+#endif
+}
+
+IoUring::~IoUring() {
+    if (sqes_) munmap(sqes_, sqes_size_);
+    if (cq_ring_ && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_) munmap(sq_ring_, sq_ring_size_);
+    if (fd_ >= 0) close(fd_);
+}
+
+io_uring_sqe* IoUring::get_sqe() {
+    if (sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+        submit(0, std::chrono::milliseconds(0));
+    }
+    unsigned index = sqe_tail_ & sq_mask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    ++sqe_tail_;
+    return sqe;
+}
+
+void IoUring::submit_and_wait(std::chrono::milliseconds timeout) {
+    submit(1, timeout);
+}
+
+void IoUring::submit(unsigned wait_nr, std::chrono::milliseconds timeout) {
+#ifdef IORING_FEAT_EXT_ARG
+    __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+    unsigned to_submit = sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+
+    __kernel_timespec ts{};
+    ts.tv_sec = timeout.count() / 1000;
+    ts.tv_nsec = (timeout.count() % 1000) * 1000000;
+    io_uring_getevents_arg arg{};
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+
+    unsigned flags = IORING_ENTER_EXT_ARG;
+    if (wait_nr > 0) flags |= IORING_ENTER_GETEVENTS;
+    while (sys_io_uring_enter(fd_, to_submit, wait_nr, flags, &arg, sizeof(arg)) < 0 &&
+           errno == EINTR) {
+        to_submit = sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    }
+#endif
+}
+
+bool IoUring::register_buffer_slots(unsigned count) {
+#ifdef IORING_RSRC_REGISTER_SPARSE
+    io_uring_rsrc_register reg{};
+    reg.nr = count;
+    reg.flags = IORING_RSRC_REGISTER_SPARSE;
+    if (sys_io_uring_register(fd_, IORING_REGISTER_BUFFERS2, &reg, sizeof(reg)) < 0) {
+        return false;
+    }
+    buffer_slots_ = count;
+    return true;
+#else
+    (void)count;
+    return false;
+#endif
+}
+
+bool IoUring::set_buffer(unsigned slot, void* data, size_t size) {
+#ifdef IORING_RSRC_REGISTER_SPARSE
+    iovec iov{data, data ? size : 0};
+    io_uring_rsrc_update2 update{};
+    update.offset = slot;
+    update.data = reinterpret_cast<uint64_t>(&iov);
+    update.nr = 1;
+    return sys_io_uring_register(fd_, IORING_REGISTER_BUFFERS_UPDATE, &update, sizeof(update)) >= 0;
+#else
+    (void)slot;
+    (void)data;
+    (void)size;
+    return false;
+#endif
+}
+
+}
+
+#endif
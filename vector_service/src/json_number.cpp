@@ -0,0 +1,224 @@
+#include "json_number.hpp"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace vectordb {
+namespace json {
+
+namespace {
+
+constexpr double POWERS_OF_TEN[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+constexpr int64_t MAX_EXACT_POWER = 22;
+constexpr uint64_t MAX_EXACT_MANTISSA = uint64_t(1) << 53;
+constexpr size_t MAX_MANTISSA_DIGITS = 19;
+
+inline bool is_digit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+inline bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline uint64_t load_eight(const char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big) {
+        value = __builtin_bswap64(value);
+    }
+    return value;
+}
+
+// SWAR digit tests and conversion, eight ASCII bytes per step.
+inline bool is_eight_digits(uint64_t value) {
+    return (((value & 0xF0F0F0F0F0F0F0F0) |
+             (((value + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+            0x3333333333333333);
+}
+
+inline uint32_t parse_eight_digits(uint64_t value) {
+    constexpr uint64_t mask = 0x000000FF000000FF;
+    constexpr uint64_t mul1 = 0x000F424000000064;  // 100 + (1000000 << 32)
+    constexpr uint64_t mul2 = 0x0000271000000001;  // 1 + (10000 << 32)
+    value -= 0x3030303030303030;
+    value = (value * 10) + (value >> 8);
+    value = (((value & mask) * mul1) + (((value >> 16) & mask) * mul2)) >> 32;
+    return static_cast<uint32_t>(value);
+}
+
+inline const char* consume_digits(const char* p, const char* last, uint64_t& mantissa) {
+    while (last - p >= 8) {
+        uint64_t chunk = load_eight(p);
+        if (!is_eight_digits(chunk)) break;
+        mantissa = mantissa * 100000000 + parse_eight_digits(chunk);
+        p += 8;
+    }
+    while (p != last && is_digit(*p)) {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+        ++p;
+    }
+    return p;
+}
+
+// Digits after leading zeros; only needed once the raw count is too long.
+size_t significant_digits(const char* p, const char* last) {
+    while (p != last && (*p == '0' || *p == '.')) ++p;
+    size_t count = 0;
+    for (; p != last; ++p) {
+        if (is_digit(*p)) ++count;
+    }
+    return count;
+}
+
+const char* parse_slow(const char* digits, const char* last, bool negative, int64_t exponent,
+                       float& value) {
+    auto [ptr, ec] = std::from_chars(digits, last, value);
+    if (ptr == digits) return nullptr;
+    // from_chars leaves the value untouched when out of range; saturate the
+    // way strtof does.
+    if (ec == std::errc::result_out_of_range) {
+        value = exponent < 0 ? 0.0f : std::numeric_limits<float>::infinity();
+    }
+    if (negative) value = -value;
+    return ptr;
+}
+
+}
+
+const char* parse_float(const char* first, const char* last, float& value) {
+    const char* p = first;
+    bool negative = false;
+    if (p != last && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    const char* digits = p;
+
+    uint64_t mantissa = 0;
+    p = consume_digits(p, last, mantissa);
+    size_t digit_count = p - digits;
+
+    int64_t exponent = 0;
+    const char* end_of_digits = p;
+    if (p != last && *p == '.') {
+        const char* fraction = ++p;
+        p = consume_digits(p, last, mantissa);
+        exponent = -(p - fraction);
+        digit_count += p - fraction;
+        end_of_digits = p;
+    }
+    if (digit_count == 0) return first;
+
+    if (p != last && (*p == 'e' || *p == 'E')) {
+        const char* e = p + 1;
+        bool negative_exp = false;
+        if (e != last && (*e == '-' || *e == '+')) {
+            negative_exp = *e == '-';
+            ++e;
+        }
+        if (e == last || !is_digit(*e)) return first;
+        int64_t exp_value = 0;
+        for (; e != last && is_digit(*e); ++e) {
+            if (exp_value < 100000) exp_value = exp_value * 10 + (*e - '0');
+        }
+        exponent += negative_exp ? -exp_value : exp_value;
+        p = e;
+    }
+
+    if (digit_count > MAX_MANTISSA_DIGITS &&
+        significant_digits(digits, end_of_digits) > MAX_MANTISSA_DIGITS) {
+        return parse_slow(digits, p, negative, exponent, value) ? p : first;
+    }
+
+    if (mantissa == 0) {
+        value = negative ? -0.0f : 0.0f;
+        return p;
+    }
+
+    // Clinger's fast path: both operands are exact doubles, so one IEEE
+    // multiply or divide gives the correctly rounded double.
+    if (mantissa <= MAX_EXACT_MANTISSA && exponent >= -MAX_EXACT_POWER &&
+        exponent <= MAX_EXACT_POWER) {
+        double d = static_cast<double>(mantissa);
+        d = exponent < 0 ? d / POWERS_OF_TEN[-exponent] : d * POWERS_OF_TEN[exponent];
+
+        // Narrowing to float rounds a second time. That can only go wrong
+        // when the double sits exactly halfway between two floats, or when
+        // the float would be subnormal and lose more bits.
+        uint64_t bits = std::bit_cast<uint64_t>(d);
+        bool halfway = (bits & 0x1FFFFFFF) == 0x10000000;
+        if (!halfway && d >= std::numeric_limits<float>::min()) {
+            float f = static_cast<float>(d);
+            value = negative ? -f : f;
+            return p;
+        }
+    }
+
+    return parse_slow(digits, p, negative, exponent, value) ? p : first;
+}
+
+size_t parse_float_array(std::string_view json, size_t bracket_pos, std::vector<float>& out) {
+    if (bracket_pos >= json.size() || json[bracket_pos] != '[') return std::string_view::npos;
+
+    const char* base = json.data();
+    const char* last = base + json.size();
+    const char* p = base + bracket_pos + 1;
+
+    // Size the output exactly from the separator count. memchr and the comma
+    // count are both vectorized scans, far cheaper than regrowing the vector.
+    const char* close = static_cast<const char*>(std::memchr(p, ']', last - p));
+    if (!close) return std::string_view::npos;
+    out.reserve(out.size() + std::count(p, close, ',') + 1);
+
+    while (p != close && is_space(*p)) ++p;
+    if (p == close) return close - base + 1;
+
+    while (true) {
+        float value;
+        const char* next = parse_float(p, close, value);
+        if (next == p) return std::string_view::npos;
+        out.push_back(value);
+
+        p = next;
+        while (p != close && is_space(*p)) ++p;
+        if (p == close) return close - base + 1;
+        if (*p != ',') return std::string_view::npos;
+        ++p;
+        while (p != close && is_space(*p)) ++p;
+    }
+}
+
+FloatText format_float(float value) {
+    FloatText text;
+    if (!std::isfinite(value)) {
+        std::memcpy(text.data, "null", 4);
+        text.size = 4;
+        return text;
+    }
+    auto [ptr, ec] = std::to_chars(text.data, text.data + sizeof(text.data), value);
+    text.size = static_cast<uint8_t>(ptr - text.data);
+    return text;
+}
+
+void append_float(std::string& out, float value) {
+    out.append(format_float(value).view());
+}
+
+void append_float_array(std::string& out, const float* values, size_t count) {
+    out.push_back('[');
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) out.push_back(',');
+        append_float(out, values[i]);
+    }
+    out.push_back(']');
+}
+
+}
+}
@@ -0,0 +1,397 @@
+#include "json_parser.hpp"
+#include "json_number.hpp"
+#include <charconv>
+#include <cstring>
+
+namespace vectordb {
+namespace json {
+
+namespace {
+
+constexpr size_t MAX_DEPTH = 256;
+
+inline bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+}
+
+class Document::Parser {
+public:
+    Parser(Document& doc, std::string_view input)
+        : doc_(doc), begin_(input.data()), p_(input.data()), end_(input.data() + input.size()) {}
+
+    bool run() {
+        skip_space();
+        if (!parse_value(0)) return false;
+        skip_space();
+        if (p_ != end_) return fail("Unexpected data after JSON value");
+        return true;
+    }
+
+private:
+    Document& doc_;
+    const char* begin_;
+    const char* p_;
+    const char* end_;
+
+    bool fail(const char* message) {
+        if (doc_.error_.empty()) {
+            doc_.error_ = std::string(message) + " at offset " + std::to_string(p_ - begin_);
+        }
+        return false;
+    }
+
+    void skip_space() {
+        while (p_ != end_ && is_space(*p_)) ++p_;
+    }
+
+    uint32_t push(Type type) {
+        doc_.nodes_.push_back({type});
+        return static_cast<uint32_t>(doc_.nodes_.size() - 1);
+    }
+
+    void close(uint32_t index) {
+        doc_.nodes_[index].next = static_cast<uint32_t>(doc_.nodes_.size());
+    }
+
+    bool parse_value(size_t depth) {
+        if (p_ == end_) return fail("Unexpected end of input");
+        switch (*p_) {
+            case '{': return parse_object(depth);
+            case '[': return parse_array(depth);
+            case '"': {
+                uint32_t index = push(Type::String);
+                if (!parse_string(doc_.nodes_[index].text)) return false;
+                close(index);
+                return true;
+            }
+            case 't': return parse_literal("true", Type::Bool, true);
+            case 'f': return parse_literal("false", Type::Bool, false);
+            case 'n': return parse_literal("null", Type::Null, false);
+            default: return parse_number();
+        }
+    }
+
+    bool parse_literal(std::string_view word, Type type, bool flag) {
+        if (static_cast<size_t>(end_ - p_) < word.size() ||
+            std::memcmp(p_, word.data(), word.size()) != 0) {
+            return fail("Invalid literal");
+        }
+        uint32_t index = push(type);
+        doc_.nodes_[index].flag = flag;
+        doc_.nodes_[index].text = std::string_view(p_, word.size());
+        p_ += word.size();
+        close(index);
+        return true;
+    }
+
+    bool parse_number() {
+        float ignored;
+        const char* end = parse_float(p_, end_, ignored);
+        if (end == p_) return fail("Invalid value");
+        uint32_t index = push(Type::Number);
+        doc_.nodes_[index].text = std::string_view(p_, end - p_);
+        p_ = end;
+        close(index);
+        return true;
+    }
+
+    bool parse_string(std::string_view& out) {
+        const char* start = ++p_;
+        while (p_ != end_ && *p_ != '"' && *p_ != '\\') ++p_;
+        if (p_ == end_) return fail("Unterminated string");
+        if (*p_ == '"') {
+            out = std::string_view(start, p_ - start);
+            ++p_;
+            return true;
+        }
+
+        // Escapes present: decode into storage the Document owns.
+        std::string& decoded = doc_.decoded_.emplace_back(start, p_ - start);
+        while (p_ != end_ && *p_ != '"') {
+            if (*p_ != '\\') {
+                decoded.push_back(*p_++);
+                continue;
+            }
+            if (++p_ == end_) break;
+            char c = *p_++;
+            switch (c) {
+                case '"': decoded.push_back('"'); break;
+                case '\\': decoded.push_back('\\'); break;
+                case '/': decoded.push_back('/'); break;
+                case 'b': decoded.push_back('\b'); break;
+                case 'f': decoded.push_back('\f'); break;
+                case 'n': decoded.push_back('\n'); break;
+                case 'r': decoded.push_back('\r'); break;
+                case 't': decoded.push_back('\t'); break;
+                case 'u': {
+                    uint32_t cp;
+                    if (!parse_hex4(cp)) return fail("Invalid \\u escape");
+                    if (cp >= 0xD800 && cp <= 0xDBFF) {
+                        uint32_t low;
+                        if (end_ - p_ >= 6 && p_[0] == '\\' && p_[1] == 'u') {
+                            p_ += 2;
+                            if (!parse_hex4(low)) return fail("Invalid \\u escape");
+                            cp = (low >= 0xDC00 && low <= 0xDFFF)
+                                ? 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00)
+                                : 0xFFFD;
+                        } else {
+                            cp = 0xFFFD;
+                        }
+                    } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                        cp = 0xFFFD;
+                    }
+                    append_utf8(decoded, cp);
+                    break;
+                }
+                default:
+                    return fail("Invalid escape");
+            }
+        }
+        if (p_ == end_) return fail("Unterminated string");
+        ++p_;
+        out = decoded;
+        return true;
+    }
+
+    bool parse_hex4(uint32_t& cp) {
+        if (end_ - p_ < 4) return false;
+        cp = 0;
+        for (int i = 0; i < 4; ++i) {
+            int v = hex_value(*p_++);
+            if (v < 0) return false;
+            cp = (cp << 4) | static_cast<uint32_t>(v);
+        }
+        return true;
+    }
+
+    bool parse_object(size_t depth) {
+        if (depth >= MAX_DEPTH) return fail("Nesting too deep");
+        const char* start = p_++;
+        uint32_t index = push(Type::Object);
+        uint32_t members = 0;
+
+        skip_space();
+        if (p_ != end_ && *p_ == '}') {
+            ++p_;
+        } else {
+            while (true) {
+                if (p_ == end_ || *p_ != '"') return fail("Expected object key");
+                uint32_t key = push(Type::String);
+                if (!parse_string(doc_.nodes_[key].text)) return false;
+                close(key);
+
+                skip_space();
+                if (p_ == end_ || *p_ != ':') return fail("Expected ':'");
+                ++p_;
+                skip_space();
+                if (!parse_value(depth + 1)) return false;
+                members++;
+
+                skip_space();
+                if (p_ != end_ && *p_ == ',') {
+                    ++p_;
+                    skip_space();
+                    continue;
+                }
+                if (p_ != end_ && *p_ == '}') {
+                    ++p_;
+                    break;
+                }
+                return fail("Expected ',' or '}'");
+            }
+        }
+
+        auto& node = doc_.nodes_[index];
+        node.size = members;
+        node.text = std::string_view(start, p_ - start);
+        close(index);
+        return true;
+    }
+
+    bool parse_array(size_t depth) {
+        if (depth >= MAX_DEPTH) return fail("Nesting too deep");
+        const char* start = p_++;
+        uint32_t index = push(Type::Array);
+
+        // Vectors are arrays of numbers: parse those straight into the float
+        // pool. Anything else in the array rewinds to the general path.
+        if (parse_packed_floats(index)) {
+            doc_.nodes_[index].text = std::string_view(start, p_ - start);
+            close(index);
+            return true;
+        }
+
+        uint32_t elements = 0;
+        skip_space();
+        if (p_ != end_ && *p_ == ']') {
+            ++p_;
+        } else {
+            while (true) {
+                if (!parse_value(depth + 1)) return false;
+                elements++;
+
+                skip_space();
+                if (p_ != end_ && *p_ == ',') {
+                    ++p_;
+                    skip_space();
+                    continue;
+                }
+                if (p_ != end_ && *p_ == ']') {
+                    ++p_;
+                    break;
+                }
+                return fail("Expected ',' or ']'");
+            }
+        }
+
+        auto& node = doc_.nodes_[index];
+        node.size = elements;
+        node.text = std::string_view(start, p_ - start);
+        close(index);
+        return true;
+    }
+
+    bool parse_packed_floats(uint32_t index) {
+        const char* rewind = p_;
+        auto& floats = doc_.floats_;
+        size_t first = floats.size();
+
+        skip_space();
+        if (p_ == end_ || (*p_ != '-' && !(*p_ >= '0' && *p_ <= '9'))) {
+            p_ = rewind;
+            return false;
+        }
+
+        while (true) {
+            float value;
+            const char* next = parse_float(p_, end_, value);
+            if (next == p_) break;
+            floats.push_back(value);
+            p_ = next;
+
+            skip_space();
+            if (p_ != end_ && *p_ == ',') {
+                ++p_;
+                skip_space();
+                continue;
+            }
+            if (p_ != end_ && *p_ == ']') {
+                ++p_;
+                auto& node = doc_.nodes_[index];
+                node.flag = true;
+                node.offset = static_cast<uint32_t>(first);
+                node.size = static_cast<uint32_t>(floats.size() - first);
+                return true;
+            }
+            break;
+        }
+
+        floats.resize(first);
+        p_ = rewind;
+        return false;
+    }
+};
+
+bool Document::parse(std::string_view input) {
+    nodes_.clear();
+    floats_.clear();
+    decoded_.clear();
+    error_.clear();
+
+    Parser parser(*this, input);
+    if (!parser.run()) {
+        nodes_.clear();
+        return false;
+    }
+    return true;
+}
+
+Type Value::type() const {
+    return doc_ ? doc_->nodes_[index_].type : Type::Null;
+}
+
+Value Value::operator[](std::string_view key) const {
+    if (!is_object()) return {};
+    const auto& nodes = doc_->nodes_;
+    uint32_t end = nodes[index_].next;
+    for (uint32_t i = index_ + 1; i < end; i = nodes[i + 1].next) {
+        if (nodes[i].text == key) return Value(doc_, i + 1);
+    }
+    return {};
+}
+
+std::string_view Value::string_view(std::string_view fallback) const {
+    return is_string() ? doc_->nodes_[index_].text : fallback;
+}
+
+std::string Value::string(std::string_view fallback) const {
+    return std::string(string_view(fallback));
+}
+
+int64_t Value::get_int(int64_t fallback) const {
+    if (!is_number()) return fallback;
+    auto text = doc_->nodes_[index_].text;
+    int64_t value = fallback;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() ? value : fallback;
+}
+
+float Value::get_float(float fallback) const {
+    if (!is_number()) return fallback;
+    auto text = doc_->nodes_[index_].text;
+    float value = fallback;
+    parse_float(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+bool Value::get_bool(bool fallback) const {
+    return doc_ && type() == Type::Bool ? doc_->nodes_[index_].flag : fallback;
+}
+
+std::string_view Value::text() const {
+    return doc_ ? doc_->nodes_[index_].text : std::string_view();
+}
+
+size_t Value::size() const {
+    return is_array() || is_object() ? doc_->nodes_[index_].size : 0;
+}
+
+bool Value::is_float_array() const {
+    return is_array() && doc_->nodes_[index_].flag;
+}
+
+std::span<const float> Value::floats() const {
+    if (!is_float_array()) return {};
+    const auto& node = doc_->nodes_[index_];
+    return std::span<const float>(doc_->floats_.data() + node.offset, node.size);
+}
+
+}
+}
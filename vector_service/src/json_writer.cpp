@@ -0,0 +1,120 @@
+#include "json_writer.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace vectordb {
+namespace json {
+
+namespace {
+
+// A worker's scratch buffer is dropped after a response larger than this
+// rather than kept for the life of the thread.
+constexpr size_t SCRATCH_KEEP = 4 * 1024 * 1024;
+
+thread_local std::string scratch;
+thread_local bool scratch_in_use = false;
+
+constexpr uint64_t ONES = 0x0101010101010101ull;
+constexpr uint64_t HIGHS = 0x8080808080808080ull;
+
+// Non-zero if any byte of the word is a control character, '"' or '\\'.
+// Bytes >= 0x80 never match, so UTF-8 text is scanned eight bytes at a time.
+inline uint64_t needs_escape(uint64_t word) {
+    uint64_t quote = word ^ (ONES * '"');
+    uint64_t backslash = word ^ (ONES * '\\');
+    uint64_t hits = (word - ONES * 0x20) | (quote - ONES) | (backslash - ONES);
+    return hits & ~word & HIGHS;
+}
+
+inline bool is_special(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+void append_escape(std::string& out, unsigned char c) {
+    static const char hex[] = "0123456789abcdef";
+    switch (c) {
+        case '"': out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+        case '\b': out.append("\\b"); break;
+        case '\f': out.append("\\f"); break;
+        default: {
+            char buf[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+            out.append(buf, sizeof(buf));
+        }
+    }
+}
+
+}
+
+void append_quoted(std::string& out, std::string_view text) {
+    out.push_back('"');
+    const char* run = text.data();
+    const char* p = run;
+    const char* end = run + text.size();
+    while (p != end) {
+        if (end - p >= 8) {
+            uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            if (!needs_escape(word)) {
+                p += 8;
+                continue;
+            }
+        }
+        // A word with a hit (or the tail): find it byte by byte.
+        const char* stop = std::min(p + 8, end);
+        for (; p != stop; ++p) {
+            unsigned char c = static_cast<unsigned char>(*p);
+            if (!is_special(c)) continue;
+            out.append(run, p - run);
+            append_escape(out, c);
+            run = p + 1;
+        }
+    }
+    out.append(run, end - run);
+    out.push_back('"');
+}
+
+Writer::Writer() {
+    if (scratch_in_use) {
+        out_ = &owned_;
+        return;
+    }
+    scratch_in_use = true;
+    scratch_ = true;
+    scratch.clear();
+    out_ = &scratch;
+}
+
+Writer::~Writer() {
+    if (!scratch_) return;
+    if (scratch.capacity() > SCRATCH_KEEP) {
+        std::string().swap(scratch);
+    }
+    scratch_in_use = false;
+}
+
+Writer& Writer::string(std::string_view text) {
+    append_quoted(*out_, text);
+    return *this;
+}
+
+Writer& Writer::string_map(const std::unordered_map<std::string, std::string>& map) {
+    out_->push_back('{');
+    bool first = true;
+    for (const auto& [key, value] : map) {
+        if (!first) out_->push_back(',');
+        append_quoted(*out_, key);
+        out_->push_back(':');
+        append_quoted(*out_, value);
+        first = false;
+    }
+    out_->push_back('}');
+    return *this;
+}
+
+}
+}
@@ -0,0 +1,168 @@
+#include "latency_histogram.hpp"
+#include <algorithm>
+#include <bit>
+#include <mutex>
+
+namespace vectordb {
+
+namespace {
+
+// Threads take shard slots round-robin on first use, so up to SHARDS
+// threads each record into their own.
+size_t thread_slot() {
+    static std::atomic<size_t> next{0};
+    thread_local size_t slot = next.fetch_add(1, std::memory_order_relaxed) % LatencyHistogram::SHARDS;
+    return slot;
+}
+
+double to_ms(uint64_t micros) {
+    return micros / 1000.0;
+}
+
+}
+
+LatencyHistogram::~LatencyHistogram() {
+    for (auto& shard : shards_) delete shard.load(std::memory_order_relaxed);
+}
+
+size_t LatencyHistogram::bucket_of(uint64_t micros) {
+    if (micros < SUB_BUCKETS) return micros;
+    micros = std::min<uint64_t>(micros, (uint64_t(1) << MAX_EXPONENT) - 1);
+    size_t shift = std::bit_width(micros) - 1 - SUB_BUCKET_BITS;
+    return SUB_BUCKETS + shift * SUB_BUCKETS + ((micros >> shift) - SUB_BUCKETS);
+}
+
+uint64_t LatencyHistogram::bucket_value(size_t bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+    size_t shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+    uint64_t low = (SUB_BUCKETS + (bucket - SUB_BUCKETS) % SUB_BUCKETS) << shift;
+    return low + ((uint64_t(1) << shift) >> 1);
+}
+
+LatencyHistogram::Shard& LatencyHistogram::local_shard() {
+    auto& slot = shards_[thread_slot()];
+    Shard* shard = slot.load(std::memory_order_acquire);
+    if (shard) return *shard;
+
+    auto* fresh = new Shard();
+    if (slot.compare_exchange_strong(shard, fresh, std::memory_order_acq_rel)) {
+        return *fresh;
+    }
+    delete fresh;  // another thread sharing the slot got there first
+    return *shard;
+}
+
+void LatencyHistogram::record(clock::duration elapsed) {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    record_us(micros > 0 ? static_cast<uint64_t>(micros) : 0);
+}
+
+void LatencyHistogram::record_us(uint64_t micros) {
+    Shard& shard = local_shard();
+    shard.counts[bucket_of(micros)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum_us.fetch_add(micros, std::memory_order_relaxed);
+
+    uint64_t max = shard.max_us.load(std::memory_order_relaxed);
+    while (micros > max &&
+           !shard.max_us.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {
+    }
+}
+
+LatencyHistogram::Summary LatencyHistogram::summary() const {
+    std::array<uint64_t, BUCKETS> counts{};
+    uint64_t sum_us = 0;
+    uint64_t max_us = 0;
+    for (const auto& slot : shards_) {
+        const Shard* shard = slot.load(std::memory_order_acquire);
+        if (!shard) continue;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            counts[i] += shard->counts[i].load(std::memory_order_relaxed);
+        }
+        sum_us += shard->sum_us.load(std::memory_order_relaxed);
+        max_us = std::max(max_us, shard->max_us.load(std::memory_order_relaxed));
+    }
+
+    Summary summary;
+    for (uint64_t c : counts) summary.count += c;
+    if (summary.count == 0) return summary;
+
+    auto percentile = [&](double p) {
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p * summary.count + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return to_ms(std::min(bucket_value(i), max_us));
+        }
+        return to_ms(max_us);
+    };
+
+    summary.mean_ms = to_ms(sum_us) / summary.count;
+    summary.p50_ms = percentile(0.50);
+    summary.p95_ms = percentile(0.95);
+    summary.p99_ms = percentile(0.99);
+    summary.p999_ms = percentile(0.999);
+    summary.max_ms = to_ms(max_us);
+    return summary;
+}
+
+void LatencyMetrics::record(std::string_view collection, std::string_view endpoint,
+                            LatencyHistogram::clock::duration elapsed) {
+    // Only the first call for a collection and endpoint takes the lock
+    // exclusively.
+    {
+        std::shared_lock lock(mutex_);
+        auto it = collections_.find(collection);
+        if (it == collections_.end() && collections_.size() >= max_collections_) {
+            it = collections_.find(OTHER_COLLECTION);
+        }
+        if (it != collections_.end()) {
+            auto endpoint_it = it->second.find(endpoint);
+            if (endpoint_it != it->second.end()) {
+                endpoint_it->second->record(elapsed);
+                return;
+            }
+        }
+    }
+
+    std::unique_lock lock(mutex_);
+    if (!collections_.contains(collection) && collections_.size() >= max_collections_) {
+        collection = OTHER_COLLECTION;
+    }
+    auto it = collections_.find(collection);
+    if (it == collections_.end()) {
+        it = collections_.emplace(std::string(collection), Endpoints()).first;
+    }
+    auto endpoint_it = it->second.find(endpoint);
+    if (endpoint_it == it->second.end()) {
+        endpoint_it = it->second.emplace(std::string(endpoint), std::make_unique<LatencyHistogram>()).first;
+    }
+    endpoint_it->second->record(elapsed);
+}
+
+void LatencyMetrics::append(std::vector<Entry>& out, const std::string& collection,
+                            const Endpoints& endpoints) {
+    for (const auto& [endpoint, histogram] : endpoints) {
+        out.push_back({collection, endpoint, histogram->summary()});
+    }
+}
+
+std::vector<LatencyMetrics::Entry> LatencyMetrics::snapshot() const {
+    std::vector<Entry> entries;
+    std::shared_lock lock(mutex_);
+    for (const auto& [collection, endpoints] : collections_) {
+        append(entries, collection, endpoints);
+    }
+    return entries;
+}
+
+std::vector<LatencyMetrics::Entry> LatencyMetrics::snapshot(std::string_view collection) const {
+    std::vector<Entry> entries;
+    std::shared_lock lock(mutex_);
+    auto it = collections_.find(collection);
+    if (it != collections_.end()) {
+        append(entries, it->first, it->second);
+    }
+    return entries;
+}
+
+}
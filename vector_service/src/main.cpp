@@ -3,6 +3,9 @@
 #include <memory>
 #include <string>
 #include <cstdlib>
+#include <chrono>
+#include <sstream>
+#include <vector>
 #include "grpc_server.hpp"
 #include "http_server.hpp"
 #include "vector_storage.hpp"
@@ -12,6 +15,31 @@ namespace {
     std::unique_ptr<vectordb::HTTPServer> g_http_server;
 }
 
+// "0,2,4-7" -> {0, 2, 4, 5, 6, 7}
+std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        size_t dash = item.find('-');
+        int first = std::atoi(item.substr(0, dash).c_str());
+        int last = dash == std::string::npos ? first : std::atoi(item.substr(dash + 1).c_str());
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+vectordb::IOBackend parse_io_backend(const std::string& name) {
+    if (name == "io_uring" || name == "uring") return vectordb::IOBackend::IoUring;
+    if (name != "epoll") {
+        std::cerr << "Unknown HTTP I/O backend '" << name << "', using epoll" << std::endl;
+    }
+    return vectordb::IOBackend::Epoll;
+}
+
 void signal_handler(int signal) {
     std::cout << "\nReceived signal " << signal << ", shutting down..." << std::endl;
     if (g_http_server) {
@@ -24,7 +52,10 @@ void signal_handler(int signal) {
 
 int main(int argc, char* argv[]) {
     std::string grpc_address = "0.0.0.0:50051";
-    int http_port = 50052;
+    vectordb::HTTPServerConfig http_config;
+    vectordb::AdmissionConfig admission_config;
+    std::string grpc_unix_socket;
+    vectordb::GRPCServerConfig grpc_config;
     std::string data_dir = "./data";
 
     if (const char* env_port = std::getenv("VECTOR_PORT")) {
@@ -32,7 +63,51 @@ int main(int argc, char* argv[]) {
     }
 
     if (const char* env_http = std::getenv("VECTOR_HTTP_PORT")) {
-        http_port = std::atoi(env_http);
+        http_config.port = std::atoi(env_http);
+    }
+
+    if (const char* env_unix = std::getenv("VECTOR_UNIX_SOCKET")) {
+        http_config.unix_socket = env_unix;
+    }
+
+    if (const char* env_grpc_unix = std::getenv("VECTOR_GRPC_UNIX_SOCKET")) {
+        grpc_unix_socket = env_grpc_unix;
+    }
+
+    if (const char* env_grpc_threads = std::getenv("VECTOR_GRPC_THREADS")) {
+        grpc_config.num_workers = std::strtoul(env_grpc_threads, nullptr, 10);
+    }
+
+    if (const char* env_grpc_quota = std::getenv("VECTOR_GRPC_MEMORY_QUOTA_MB")) {
+        grpc_config.memory_quota_bytes = std::strtoull(env_grpc_quota, nullptr, 10) * 1024 * 1024;
+    }
+
+    if (const char* env_threads = std::getenv("VECTOR_HTTP_THREADS")) {
+        http_config.num_workers = std::strtoul(env_threads, nullptr, 10);
+    }
+
+    if (const char* env_shards = std::getenv("VECTOR_HTTP_SHARDS")) {
+        http_config.num_shards = std::strtoul(env_shards, nullptr, 10);
+    }
+
+    if (const char* env_cpus = std::getenv("VECTOR_HTTP_CPUS")) {
+        http_config.shard_cpus = parse_cpu_list(env_cpus);
+    }
+
+    if (const char* env_io = std::getenv("VECTOR_HTTP_IO")) {
+        http_config.io_backend = parse_io_backend(env_io);
+    }
+
+    if (const char* env_body = std::getenv("VECTOR_HTTP_MAX_BODY_MB")) {
+        http_config.max_body_size = std::strtoull(env_body, nullptr, 10) * 1024 * 1024;
+    }
+
+    if (const char* env_pending = std::getenv("VECTOR_MAX_PENDING")) {
+        admission_config.max_pending = std::strtoul(env_pending, nullptr, 10);
+    }
+
+    if (const char* env_tenant = std::getenv("VECTOR_TENANT_MAX_IN_FLIGHT")) {
+        admission_config.max_tenant_in_flight = std::strtoul(env_tenant, nullptr, 10);
     }
 
     if (const char* env_data = std::getenv("VECTOR_DATA_DIR")) {
@@ -44,7 +119,33 @@ int main(int argc, char* argv[]) {
         if (arg == "--port" && i + 1 < argc) {
             grpc_address = std::string("0.0.0.0:") + argv[++i];
         } else if (arg == "--http-port" && i + 1 < argc) {
-            http_port = std::atoi(argv[++i]);
+            http_config.port = std::atoi(argv[++i]);
+        } else if (arg == "--unix-socket" && i + 1 < argc) {
+            http_config.unix_socket = argv[++i];
+        } else if (arg == "--grpc-unix-socket" && i + 1 < argc) {
+            grpc_unix_socket = argv[++i];
+        } else if (arg == "--grpc-threads" && i + 1 < argc) {
+            grpc_config.num_workers = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--grpc-memory-quota" && i + 1 < argc) {
+            grpc_config.memory_quota_bytes = std::strtoull(argv[++i], nullptr, 10) * 1024 * 1024;
+        } else if (arg == "--http-threads" && i + 1 < argc) {
+            http_config.num_workers = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--http-shards" && i + 1 < argc) {
+            http_config.num_shards = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--http-cpus" && i + 1 < argc) {
+            http_config.shard_cpus = parse_cpu_list(argv[++i]);
+        } else if (arg == "--http-io" && i + 1 < argc) {
+            http_config.io_backend = parse_io_backend(argv[++i]);
+        } else if (arg == "--http-idle-timeout" && i + 1 < argc) {
+            http_config.idle_timeout = std::chrono::seconds(std::atoi(argv[++i]));
+        } else if (arg == "--http-max-requests" && i + 1 < argc) {
+            http_config.max_requests_per_connection = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--http-max-body" && i + 1 < argc) {
+            http_config.max_body_size = std::strtoull(argv[++i], nullptr, 10) * 1024 * 1024;
+        } else if (arg == "--max-pending" && i + 1 < argc) {
+            admission_config.max_pending = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--tenant-max-in-flight" && i + 1 < argc) {
+            admission_config.max_tenant_in_flight = std::strtoul(argv[++i], nullptr, 10);
         } else if (arg == "--data" && i + 1 < argc) {
             data_dir = argv[++i];
         } else if (arg == "--help") {
@@ -52,6 +153,19 @@ int main(int argc, char* argv[]) {
                       << "Options:\n"
                       << "  --port PORT       gRPC port (default: 50051)\n"
                       << "  --http-port PORT  HTTP port (default: 50052)\n"
+                      << "  --unix-socket PATH       Also serve HTTP on this Unix socket\n"
+                      << "  --grpc-unix-socket PATH  Also serve gRPC on this Unix socket\n"
+                      << "  --grpc-threads N  gRPC handler threads (default: hardware threads)\n"
+                      << "  --grpc-memory-quota MB   Buffer memory for all gRPC calls before reads pause (default: gRPC's)\n"
+                      << "  --http-threads N  HTTP handler threads (default: hardware threads)\n"
+                      << "  --http-shards N   HTTP acceptor/reactor threads on SO_REUSEPORT sockets (default: 1)\n"
+                      << "  --http-cpus LIST  Pin HTTP shards to these CPUs, e.g. 0-3 or 0,2,4 (default: unpinned)\n"
+                      << "  --http-io BACKEND epoll or io_uring; io_uring falls back to epoll if unavailable (default: epoll)\n"
+                      << "  --http-idle-timeout SEC  Keep-alive idle timeout (default: 75)\n"
+                      << "  --http-max-requests N    Requests per keep-alive connection (default: 1000)\n"
+                      << "  --http-max-body MB       Largest HTTP request body, except streamed ingest (default: 1024)\n"
+                      << "  --max-pending N   Requests accepted before shedding with 503 (default: 1024)\n"
+                      << "  --tenant-max-in-flight N  Concurrent requests per tenant, 0 = unlimited (default: 8)\n"
                       << "  --data DIR        Data directory (default: ./data)\n"
                       << "  --help            Show this help\n";
             return 0;
@@ -65,8 +179,15 @@ int main(int argc, char* argv[]) {
     std::cout << "  Vector Service v1.0.0\n";
     std::cout << "  C++ HNSW with SIMD\n";
     std::cout << "=================================\n";
-    std::cout << "gRPC: " << grpc_address << "\n";
-    std::cout << "HTTP: 0.0.0.0:" << http_port << "\n";
+    std::cout << "gRPC: " << grpc_address << " (" << grpc_config.num_workers << " threads)\n";
+    if (!grpc_unix_socket.empty()) {
+        std::cout << "gRPC: unix:" << grpc_unix_socket << "\n";
+    }
+    std::cout << "HTTP: 0.0.0.0:" << http_config.port << " (" << http_config.num_shards << " shards, "
+              << http_config.num_workers << " threads)\n";
+    if (!http_config.unix_socket.empty()) {
+        std::cout << "HTTP: unix:" << http_config.unix_socket << "\n";
+    }
     std::cout << "Data: " << data_dir << "\n";
 
 #if defined(USE_AVX512)
@@ -81,11 +202,20 @@ int main(int argc, char* argv[]) {
 
     try {
         auto storage = std::make_shared<vectordb::VectorStorage>(data_dir);
+        // One controller for both servers, so limits hold across protocols.
+        auto admission = std::make_shared<vectordb::AdmissionController>(admission_config);
+        // Likewise one set of latency histograms, so a collection's stats
+        // cover calls over either protocol.
+        auto metrics = std::make_shared<vectordb::LatencyMetrics>();
 
-        g_http_server = std::make_unique<vectordb::HTTPServer>(http_port, storage);
+        g_http_server = std::make_unique<vectordb::HTTPServer>(http_config, storage, admission, metrics);
         g_http_server->start();
 
-        g_grpc_server = std::make_unique<vectordb::GRPCServer>(grpc_address, storage);
+        g_grpc_server = std::make_unique<vectordb::GRPCServer>(grpc_address, storage, admission,
+                                                               grpc_config, metrics);
+        if (!grpc_unix_socket.empty()) {
+            g_grpc_server->add_listening_address("unix:" + grpc_unix_socket);
+        }
         g_grpc_server->run();
 
     } catch (const std::exception& e) {
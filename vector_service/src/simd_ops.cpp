@@ -1,6 +1,10 @@
 #include "simd_ops.hpp"
 #include <cstring>
 
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
 namespace vectordb {
 namespace simd {
 
@@ -105,5 +109,53 @@ void scale_vector(const float* vec, float scalar, float* result, size_t dim) {
 #endif
 }
 
+namespace {
+
+float half_to_float(uint16_t h) {
+    uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1F;
+    uint32_t mantissa = h & 0x3FF;
+    uint32_t bits;
+    if (exponent == 0x1F) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        bits = sign;
+    } else {
+        // Subnormal: shift until the implicit bit appears.
+        exponent = 113;
+        while (!(mantissa & 0x400)) {
+            mantissa <<= 1;
+            --exponent;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+    }
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+}
+
+void f16_to_f32(const uint16_t* in, float* out, size_t dim) {
+    size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= dim; i += 8) {
+        __m128i vh = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(vh));
+    }
+#endif
+    for (; i < dim; ++i) {
+        out[i] = half_to_float(in[i]);
+    }
+}
+
+void i8_to_f32(const int8_t* in, float scale, float* out, size_t dim) {
+    for (size_t i = 0; i < dim; ++i) {
+        out[i] = in[i] * scale;
+    }
+}
+
 }
 }
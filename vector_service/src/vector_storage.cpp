@@ -76,6 +76,15 @@ bool VectorStorage::collection_exists(const std::string& name) const {
     return collections_.count(name) > 0;
 }
 
+std::optional<size_t> VectorStorage::dimension(const std::string& name) const {
+    std::shared_lock lock(mutex_);
+    auto it = collections_.find(name);
+    if (it == collections_.end()) {
+        return std::nullopt;
+    }
+    return it->second->dimension();
+}
+
 std::optional<CollectionStats> VectorStorage::get_stats(const std::string& name) const {
     std::shared_lock lock(mutex_);
 
@@ -104,7 +113,7 @@ std::optional<CollectionStats> VectorStorage::get_stats(const std::string& name)
 
 std::string VectorStorage::insert(
     const std::string& collection,
-    const std::vector<float>& vector,
+    std::span<const float> vector,
     const std::string& id,
     const std::unordered_map<std::string, std::string>& metadata)
 {
@@ -120,7 +129,21 @@ std::string VectorStorage::insert(
 
 size_t VectorStorage::batch_insert(
     const std::string& collection,
-    const std::vector<VectorData>& vectors)
+    const std::vector<VectorRecord>& vectors)
+{
+    std::shared_lock lock(mutex_);
+
+    auto it = collections_.find(collection);
+    if (it == collections_.end()) {
+        throw std::runtime_error("Collection not found: " + collection);
+    }
+
+    return it->second->batch_insert(vectors);
+}
+
+size_t VectorStorage::batch_insert(
+    const std::string& collection,
+    std::span<const VectorRef> vectors)
 {
     std::shared_lock lock(mutex_);
 
@@ -145,9 +168,12 @@ bool VectorStorage::remove(const std::string& collection, const std::string& id)
 
 std::vector<HNSWResult> VectorStorage::search(
     const std::string& collection,
-    const std::vector<float>& query,
+    std::span<const float> query,
     size_t k,
-    size_t ef) const
+    size_t ef,
+    const Deadline& deadline,
+    const MetadataFilter& filter,
+    bool include_values) const
 {
     std::shared_lock lock(mutex_);
 
@@ -156,14 +182,16 @@ std::vector<HNSWResult> VectorStorage::search(
         throw std::runtime_error("Collection not found: " + collection);
     }
 
-    return it->second->search(query, k, ef);
+    return it->second->search(query, k, ef, deadline, filter, include_values);
 }
 
 std::vector<std::vector<HNSWResult>> VectorStorage::batch_search(
     const std::string& collection,
     const std::vector<std::vector<float>>& queries,
     size_t k,
-    size_t ef) const
+    size_t ef,
+    const Deadline& deadline,
+    bool include_values) const
 {
     std::shared_lock lock(mutex_);
 
@@ -172,7 +200,7 @@ std::vector<std::vector<HNSWResult>> VectorStorage::batch_search(
         throw std::runtime_error("Collection not found: " + collection);
     }
 
-    return it->second->batch_search(queries, k, ef);
+    return it->second->batch_search(queries, k, ef, deadline, include_values);
 }
 
 const VectorData* VectorStorage::get(const std::string& collection, const std::string& id) const {
@@ -186,6 +214,19 @@ const VectorData* VectorStorage::get(const std::string& collection, const std::s
     return it->second->get(id);
 }
 
+bool VectorStorage::get_values(const std::string& collection, const std::string& id,
+                               std::vector<float>& values) const {
+    std::shared_lock lock(mutex_);
+
+    auto it = collections_.find(collection);
+    if (it == collections_.end()) {
+        values.clear();
+        return false;
+    }
+
+    return it->second->get_values(id, values);
+}
+
 bool VectorStorage::save_config(const std::string& name) const {
     auto it = configs_.find(name);
     if (it == configs_.end()) return false;
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "vector_service.pb.h"
+#include "message_arena.hpp"
+
+using namespace vectordb;
+
+// Every heap allocation in the process goes through here, so a benchmark
+// can count what building a response costs.
+static std::atomic<size_t> allocations{0};
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+constexpr size_t DIM = 128;
+
+struct Hit {
+    std::string id;
+    float score;
+    std::vector<float> values;
+};
+
+// Fills a response the way VectorServiceImpl::batch_search does.
+void fill(BatchSearchResponse* response, const std::vector<Hit>& hits, size_t queries, size_t k) {
+    for (size_t q = 0; q < queries; ++q) {
+        auto* list = response->add_results();
+        for (size_t i = 0; i < k; ++i) {
+            const Hit& hit = hits[(q * k + i) % hits.size()];
+            auto* result = list->add_results();
+            result->set_id(hit.id);
+            result->set_score(hit.score);
+            result->mutable_values()->Add(hit.values.begin(), hit.values.end());
+            auto& metadata = *result->mutable_metadata();
+            metadata["question"] = "How do I reset my password on the mobile app?";
+            metadata["answer"] = "Open Settings, choose Account, then tap Reset password.";
+            metadata["category"] = "account";
+        }
+    }
+}
+
+std::vector<Hit> make_hits() {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<Hit> hits(100);
+    for (size_t i = 0; i < hits.size(); ++i) {
+        hits[i].id = "faq-" + std::to_string(i) + "-0123456789abcdef";
+        hits[i].score = dist(rng);
+        hits[i].values.resize(DIM);
+        for (auto& v : hits[i].values) v = dist(rng);
+    }
+    return hits;
+}
+
+void test_allocator_reuses_arenas() {
+    std::cout << "Testing arena message allocator..." << std::endl;
+
+    ArenaMessageAllocator<SearchRequest, SearchResponse> allocator(1);
+
+    auto* first = allocator.AllocateMessages();
+    first->request()->set_collection("docs");
+    first->response()->add_results()->set_id("a");
+    bool on_arena = first->request()->GetArena() != nullptr &&
+                    first->request()->GetArena() == first->response()->GetArena();
+    first->Release();
+
+    auto* second = allocator.AllocateMessages();
+    bool reused = second == first;
+    bool cleared = second->request()->collection().empty() && second->response()->results_size() == 0;
+    second->Release();
+
+    if (on_arena && reused && cleared) {
+        std::cout << "  PASS: Messages share a pooled arena and start out empty" << std::endl;
+    } else {
+        std::cout << "  FAIL: on_arena=" << on_arena << " reused=" << reused
+                  << " cleared=" << cleared << std::endl;
+    }
+}
+
+void benchmark_batch_response(size_t queries, size_t k, int iterations) {
+    std::cout << "\nBenchmarking BatchSearchResponse (" << queries << " queries, k=" << k
+              << ", dim=" << DIM << ", 3 metadata fields)..." << std::endl;
+
+    auto hits = make_hits();
+
+    size_t before = allocations.load();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        BatchSearchResponse response;
+        fill(&response, hits, queries, k);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double heap_allocs = double(allocations.load() - before) / iterations;
+    double heap_us = std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+
+    ArenaMessageAllocator<BatchSearchRequest, BatchSearchResponse> allocator;
+    allocator.AllocateMessages()->Release();  // warm the pool
+
+    before = allocations.load();
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        auto* holder = allocator.AllocateMessages();
+        fill(holder->response(), hits, queries, k);
+        holder->Release();
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double arena_allocs = double(allocations.load() - before) / iterations;
+    double arena_us = std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+
+    std::cout << "  Heap:  " << heap_allocs << " allocations, " << heap_us << " us per response" << std::endl;
+    std::cout << "  Arena: " << arena_allocs << " allocations, " << arena_us << " us per response" << std::endl;
+
+    // What the arena can't absorb: protobuf 3.x keeps each string's
+    // characters on the heap once they outgrow the small-string buffer, here
+    // the id, question and answer of every result.
+    if (arena_allocs * 3 < heap_allocs) {
+        std::cout << "  PASS: Arena cuts allocations " << heap_allocs / std::max(arena_allocs, 1.0)
+                  << "x" << std::endl;
+    } else {
+        std::cout << "  FAIL: Arena saved too few allocations" << std::endl;
+    }
+}
+
+int main() {
+    std::cout << "=== gRPC Message Tests ===" << std::endl << std::endl;
+
+    test_allocator_reuses_arenas();
+    benchmark_batch_response(1, 10, 10000);
+    benchmark_batch_response(1000, 10, 20);
+
+    std::cout << "\n=== Tests Complete ===" << std::endl;
+    return 0;
+}
@@ -1,7 +1,10 @@
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <random>
 #include <chrono>
+#include <thread>
+#include <atomic>
 #include "hnsw_index.hpp"
 
 using namespace vectordb;
@@ -89,6 +92,220 @@ void test_save_load() {
     }
 }
 
+void test_values_from_index() {
+    std::cout << "\nTesting values served from the index..." << std::endl;
+
+    const size_t dim = 1536;
+    const size_t n = 500;
+    HNSWIndex index(dim);
+
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<std::vector<float>> vectors(n, std::vector<float>(dim));
+    for (size_t i = 0; i < n; ++i) {
+        for (auto& x : vectors[i]) x = dist(rng);
+        index.insert(vectors[i], "id_" + std::to_string(i), {{"n", std::to_string(i)}});
+    }
+
+    std::vector<float> values;
+    bool got = index.get_values("id_7", values) && values == vectors[7] &&
+               !index.get_values("missing", values) && values.empty();
+    index.remove("id_8");
+    values.assign(dim, 1.0f);
+    got = got && !index.get_values("id_8", values) && values.empty();
+
+    auto results = index.search(vectors[3], 5, 0, {}, {}, true);
+    auto bare = index.search(vectors[3], 5);
+    bool searched = !results.empty() && results[0].id == "id_3" && results[0].values == vectors[3] &&
+                    !bare.empty() && bare[0].values.empty();
+
+    // One copy of the floats, plus graph links and metadata, rather than two.
+    double per_vector = double(index.memory_usage()) / n;
+    double floats = dim * sizeof(float);
+    bool compact = per_vector < 1.5 * floats;
+
+    index.save("/tmp/test_hnsw_values.bin");
+    HNSWIndex loaded(dim);
+    loaded.load("/tmp/test_hnsw_values.bin");
+    bool reloaded = loaded.get_values("id_42", values) && values == vectors[42] &&
+                    loaded.get("id_42") && loaded.get("id_42")->metadata.at("n") == "42";
+
+    std::cout << "  " << per_vector << " bytes per vector (" << floats << " of floats)" << std::endl;
+    if (got && searched && compact && reloaded) {
+        std::cout << "  PASS: Values read back from the index alone" << std::endl;
+    } else {
+        std::cout << "  FAIL: got=" << got << " searched=" << searched
+                  << " compact=" << compact << " reloaded=" << reloaded << std::endl;
+    }
+}
+
+void test_filtered_search() {
+    std::cout << "\nTesting filtered search..." << std::endl;
+
+    HNSWIndex index(32);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    // 1 in 100 vectors is "rare": a post-filter over a top-k*3 over-fetch
+    // would almost never see k of them.
+    for (int i = 0; i < 2000; ++i) {
+        std::vector<float> v(32);
+        for (auto& x : v) x = dist(rng);
+        index.insert(v, "id_" + std::to_string(i),
+                     {{"kind", i % 100 == 0 ? "rare" : "common"}, {"parity", i % 2 ? "odd" : "even"}});
+    }
+
+    std::vector<float> query(32);
+    for (auto& x : query) x = dist(rng);
+
+    auto rare = index.search(query, 10, 0, {}, {{"kind", "rare"}});
+    bool all_rare = true;
+    for (const auto& r : rare) {
+        all_rare = all_rare && r.data && r.data->metadata.at("kind") == "rare";
+    }
+    if (rare.size() == 10 && all_rare) {
+        std::cout << "  PASS: Selective filter returned k matches" << std::endl;
+    } else {
+        std::cout << "  FAIL: Got " << rare.size() << " results, all matching: " << all_rare << std::endl;
+    }
+
+    auto both = index.search(query, 10, 0, {}, {{"kind", "rare"}, {"parity", "even"}});
+    auto none = index.search(query, 10, 0, {}, {{"kind", "missing"}});
+    if (both.size() == 10 && none.empty()) {
+        std::cout << "  PASS: Every key must match" << std::endl;
+    } else {
+        std::cout << "  FAIL: " << both.size() << " rare+even, " << none.size() << " missing" << std::endl;
+    }
+
+    // Fewer matches than k: all of them come back, closest first.
+    auto odd_rare = index.search(query, 10, 0, {}, {{"kind", "rare"}, {"parity", "odd"}});
+    auto few = index.search(query, 30, 0, {}, {{"kind", "rare"}});
+    bool sorted = std::is_sorted(few.begin(), few.end());
+    if (odd_rare.empty() && few.size() == 20 && sorted) {
+        std::cout << "  PASS: Returned every match when fewer than k exist" << std::endl;
+    } else {
+        std::cout << "  FAIL: " << odd_rare.size() << " rare+odd, " << few.size() << " rare of 20" << std::endl;
+    }
+}
+
+void test_concurrent_inserts() {
+    std::cout << "\nTesting concurrent inserts and searches..." << std::endl;
+
+    const size_t dim = 32;
+    const size_t threads = 8;
+    const size_t per_thread = 300;
+    HNSWConfig config;
+    config.max_elements = 1000;  // small, so inserts have to grow the graph under load
+    HNSWIndex index(dim, config);
+
+    auto vector_for = [&](size_t t, size_t i) {
+        std::vector<float> v(dim);
+        for (size_t d = 0; d < dim; ++d) v[d] = float((t * 7919 + i * 104729 + d * 31) % 1000) / 1000.0f;
+        return v;
+    };
+
+    std::atomic<size_t> duplicates_rejected{0};
+    std::atomic<size_t> searches{0};
+    std::atomic<bool> inserting{true};
+    std::vector<std::thread> writers;
+    for (size_t t = 0; t < threads; ++t) {
+        writers.emplace_back([&, t] {
+            for (size_t i = 0; i < per_thread; ++i) {
+                index.insert(vector_for(t, i), "t" + std::to_string(t) + "_" + std::to_string(i));
+            }
+            // Every thread races to insert the same id; only one may win.
+            try {
+                index.insert(vector_for(t, 0), "shared");
+            } catch (const std::exception&) {
+                duplicates_rejected++;
+            }
+        });
+    }
+    std::thread reader([&] {
+        while (inserting) {
+            index.search(vector_for(0, 0), 5);
+            searches++;
+        }
+    });
+    for (auto& w : writers) w.join();
+    inserting = false;
+    reader.join();
+
+    bool all_found = true;
+    std::vector<float> values;
+    for (size_t t = 0; t < threads && all_found; ++t) {
+        for (size_t i = 0; i < per_thread; ++i) {
+            if (!index.get_values("t" + std::to_string(t) + "_" + std::to_string(i), values) ||
+                values != vector_for(t, i)) {
+                all_found = false;
+                break;
+            }
+        }
+    }
+
+    if (index.size() == threads * per_thread + 1 && duplicates_rejected == threads - 1 && all_found) {
+        std::cout << "  PASS: " << index.size() << " vectors from " << threads << " threads, "
+                  << searches.load() << " searches alongside" << std::endl;
+    } else {
+        std::cout << "  FAIL: size=" << index.size() << " duplicates_rejected=" << duplicates_rejected.load()
+                  << " all_found=" << all_found << std::endl;
+    }
+}
+
+// Searches with one insert in every ten, as when FAQs are uploaded to a
+// collection that is also serving traffic.
+void benchmark_mixed_workload() {
+    const size_t dim = 128;
+    const size_t preload = 5000;
+    const auto duration = std::chrono::milliseconds(300);
+    std::cout << "\nBenchmarking mixed search/insert (90/10, " << preload << " vectors, dim=" << dim
+              << ", " << duration.count() << " ms per run)..." << std::endl;
+
+    HNSWIndex index(dim);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (size_t i = 0; i < preload; ++i) {
+        std::vector<float> v(dim);
+        for (auto& x : v) x = dist(rng);
+        index.insert(v);
+    }
+
+    for (size_t threads : {1, 2, 4, 8, 16, 32}) {
+        std::atomic<bool> running{true};
+        std::atomic<size_t> ops{0};
+        std::atomic<size_t> searches{0};
+        std::atomic<size_t> inserts{0};
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::mt19937 local(static_cast<unsigned>(t * 1000 + threads));
+                std::uniform_real_distribution<float> values(-1.0f, 1.0f);
+                std::vector<float> v(dim);
+                while (running) {
+                    for (auto& x : v) x = values(local);
+                    // Counted across threads, so the mix holds however few
+                    // operations each thread gets through.
+                    if (ops.fetch_add(1) % 10 == 9) {
+                        index.insert(v);
+                        inserts++;
+                    } else {
+                        index.search(v, 10);
+                        searches++;
+                    }
+                }
+            });
+        }
+        std::this_thread::sleep_for(duration);
+        running = false;
+        for (auto& w : workers) w.join();
+
+        double seconds = std::chrono::duration<double>(duration).count();
+        std::cout << "  " << threads << " threads: " << searches.load() / seconds << " searches/sec, "
+                  << inserts.load() / seconds << " inserts/sec" << std::endl;
+    }
+}
+
 void benchmark_search() {
     std::cout << "\nBenchmarking search (10k vectors, dim=1536)..." << std::endl;
 
@@ -140,7 +357,11 @@ int main() {
 
     test_basic_operations();
     test_save_load();
+    test_values_from_index();
+    test_filtered_search();
+    test_concurrent_inserts();
     benchmark_search();
+    benchmark_mixed_workload();
 
     std::cout << "\n=== Tests Complete ===" << std::endl;
     return 0;
@@ -0,0 +1,329 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include "json_number.hpp"
+#include "json_parser.hpp"
+#include "json_writer.hpp"
+
+using namespace vectordb::json;
+
+bool same_float(float a, float b) {
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+void test_parse_matches_strtof() {
+    std::cout << "Testing parse_float against strtof..." << std::endl;
+
+    std::vector<std::string> inputs = {
+        "0", "-0", "1", "-1", "0.5", "0.1", "3.14159", "-0.0123456789",
+        "0.012345678901234567", "123456789012345678901234567890",
+        "1e10", "1E-10", "-2.5e+3", "6.02214076e23", "1.17549435e-38",
+        "1e-45", "3.4028235e38", "1e39", "1e-50", "0.000000000000000000000000001",
+        "16777217", "0.30000000000000004", "9007199254740993",
+    };
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    char buf[64];
+    for (int i = 0; i < 100000; ++i) {
+        int precision = 1 + i % 17;
+        std::snprintf(buf, sizeof(buf), i % 3 == 0 ? "%.*e" : "%.*f", precision, dist(rng));
+        inputs.push_back(buf);
+    }
+
+    size_t mismatches = 0;
+    for (const auto& s : inputs) {
+        float parsed = 0.0f;
+        const char* end = parse_float(s.data(), s.data() + s.size(), parsed);
+        float expected = std::strtof(s.c_str(), nullptr);
+        if (end != s.data() + s.size() || !same_float(parsed, expected)) {
+            if (mismatches++ < 5) {
+                std::cout << "  mismatch for " << s << ": got " << parsed
+                          << ", expected " << expected << std::endl;
+            }
+        }
+    }
+
+    if (mismatches == 0) {
+        std::cout << "  PASS: " << inputs.size() << " inputs parsed identically" << std::endl;
+    } else {
+        std::cout << "  FAIL: " << mismatches << " mismatches" << std::endl;
+    }
+}
+
+void test_parse_array() {
+    std::cout << "Testing parse_float_array..." << std::endl;
+
+    std::string json = "{\"values\": [ 1, -2.5 ,3e2,\n0.25 ], \"next\": 1}";
+    std::vector<float> out;
+    size_t end = parse_float_array(json, json.find('['), out);
+
+    if (out == std::vector<float>{1.0f, -2.5f, 300.0f, 0.25f} && json[end - 1] == ']') {
+        std::cout << "  PASS: parsed 4 values" << std::endl;
+    } else {
+        std::cout << "  FAIL: got " << out.size() << " values" << std::endl;
+    }
+
+    std::vector<float> empty;
+    std::string empty_json = "[ ]";
+    if (parse_float_array(empty_json, 0, empty) == empty_json.size() && empty.empty()) {
+        std::cout << "  PASS: empty array" << std::endl;
+    } else {
+        std::cout << "  FAIL: empty array" << std::endl;
+    }
+
+    std::vector<float> bad;
+    bool rejected = parse_float_array("[1, null]", 0, bad) == std::string_view::npos &&
+                    parse_float_array("[1, 2", 0, bad) == std::string_view::npos &&
+                    parse_float_array("[1 2]", 0, bad) == std::string_view::npos;
+    if (rejected) {
+        std::cout << "  PASS: malformed arrays rejected" << std::endl;
+    } else {
+        std::cout << "  FAIL: malformed array accepted" << std::endl;
+    }
+}
+
+void test_format_round_trip() {
+    std::cout << "Testing format_float round trip..." << std::endl;
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<uint32_t> bits;
+    size_t failures = 0;
+    for (int i = 0; i < 100000; ++i) {
+        uint32_t b = bits(rng);
+        // Checked on the bits: -ffast-math folds std::isfinite to true and
+        // flushes subnormals to zero, so skip non-finite and subnormal values.
+        uint32_t exponent_bits = b & 0x7F800000;
+        if (exponent_bits == 0x7F800000 || exponent_bits == 0) continue;
+        float v;
+        std::memcpy(&v, &b, sizeof(v));
+
+        auto text = format_float(v);
+        float back = 0.0f;
+        parse_float(text.data, text.data + text.size, back);
+        if (!same_float(v, back)) failures++;
+    }
+
+    bool null_ok = format_float(std::numeric_limits<float>::quiet_NaN()).view() == "null";
+    if (failures == 0 && null_ok) {
+        std::cout << "  PASS: shortest text reads back exactly" << std::endl;
+    } else {
+        std::cout << "  FAIL: " << failures << " values did not round trip" << std::endl;
+    }
+}
+
+void test_document() {
+    std::cout << "Testing Document..." << std::endl;
+
+    std::string body = R"({"collection":"docs","top_k":5,"vectors":[
+        {"id":"a\"b","values":[0.5, -1, 2e1],"metadata":{"k":"line\nbreak","n":7,"u":"\u0e2a\ud83d\ude00"}},
+        {"id":"c","values":[1, "x"],"flag":true}
+    ]})";
+
+    Document doc;
+    if (!doc.parse(body)) {
+        std::cout << "  FAIL: parse error " << doc.error() << std::endl;
+        return;
+    }
+    auto root = doc.root();
+
+    bool fields_ok = root["collection"].string() == "docs" && root["top_k"].get_int() == 5 &&
+                     root["missing"]["deeper"].get_int(42) == 42 && root["vectors"].size() == 2;
+    std::cout << (fields_ok ? "  PASS" : "  FAIL") << ": field lookup" << std::endl;
+
+    std::vector<std::string> ids;
+    root["vectors"].for_each_element([&](const Value& v) { ids.emplace_back(v["id"].string_view()); });
+
+    bool escapes_ok = ids.size() == 2 && ids[0] == "a\"b";
+    std::string meta_k, meta_u, meta_n;
+    root["vectors"].for_each_element([&](const Value& v) {
+        if (v["id"].string_view() != "c") {
+            meta_k = v["metadata"]["k"].string();
+            meta_u = v["metadata"]["u"].string();
+            meta_n = std::string(v["metadata"]["n"].text());
+        }
+    });
+    escapes_ok = escapes_ok && meta_k == "line\nbreak" && meta_u == "\u0e2a\U0001F600" && meta_n == "7";
+    std::cout << (escapes_ok ? "  PASS" : "  FAIL") << ": escapes decoded" << std::endl;
+
+    size_t packed = 0, general = 0;
+    root["vectors"].for_each_element([&](const Value& v) {
+        auto vals = v["values"];
+        if (vals.is_float_array() && vals.floats().size() == 3 && vals.floats()[2] == 20.0f) packed++;
+        if (!vals.is_float_array() && vals.size() == 2) general++;
+    });
+    std::cout << (packed == 1 && general == 1 ? "  PASS" : "  FAIL")
+              << ": number arrays packed, mixed arrays kept as elements" << std::endl;
+
+    Document bad;
+    bool rejected = !bad.parse(R"({"a":1,})") && !bad.parse(R"({"a":"\q"})") &&
+                    !bad.parse("[1,2") && !bad.parse(R"({"a":1} x)");
+    std::cout << (rejected ? "  PASS" : "  FAIL") << ": malformed documents rejected" << std::endl;
+}
+
+void test_writer() {
+    std::cout << "Testing Writer..." << std::endl;
+
+    std::string quoted;
+    append_quoted(quoted, std::string("line\nbreak\"\\\x01"));
+    bool quoted_ok = quoted == R"("line\nbreak\"\\\u0001")";
+    std::cout << (quoted_ok ? "  PASS" : "  FAIL") << ": quoted output " << quoted << std::endl;
+
+    // Escapes at every offset around the 8-byte scan, and UTF-8 kept as is.
+    bool scan_ok = true;
+    for (size_t pos = 0; pos < 20; ++pos) {
+        std::string text(20, 'a');
+        text[pos] = '"';
+        text += "\u0e2a\u0e27\x1f";
+        std::string out;
+        append_quoted(out, text);
+        std::string expected = "\"" + std::string(pos, 'a') + "\\\"" + std::string(19 - pos, 'a') +
+                               "\u0e2a\u0e27\\u001f\"";
+        scan_ok = scan_ok && out == expected;
+    }
+    std::cout << (scan_ok ? "  PASS" : "  FAIL") << ": escapes found at any offset" << std::endl;
+
+    std::string out;
+    {
+        Writer w;
+        w.raw("{\"n\":").number(-42).raw(",\"u\":").number(size_t(18446744073709551615ull))
+         .raw(",\"f\":").number(0.1f).raw(",\"nan\":").number(std::numeric_limits<float>::quiet_NaN())
+         .raw(",\"b\":").boolean(true).raw('}');
+        // A second Writer on the same thread doesn't share the buffer.
+        Writer inner;
+        inner.raw("x");
+        out = std::string(w.view());
+    }
+    bool numbers_ok = out == R"({"n":-42,"u":18446744073709551615,"f":0.1,"nan":null,"b":true})";
+    std::cout << (numbers_ok ? "  PASS" : "  FAIL") << ": numbers " << out << std::endl;
+}
+
+void benchmark_writer() {
+    std::cout << "\nBenchmarking response serialization..." << std::endl;
+
+    // A top-10 RAG result with long Thai answers.
+    std::string answer;
+    while (answer.size() < 2000) answer += "\u0e2a\u0e27\u0e31\u0e2a\u0e14\u0e35\u0e04\u0e23\u0e31\u0e1a \"ok\"\n";
+    struct Hit { std::string id; float score; };
+    std::vector<Hit> hits;
+    for (int i = 0; i < 10; ++i) hits.push_back({"faq-" + std::to_string(i), 0.1f * i + 0.0123f});
+
+    const size_t iterations = 20000;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t it = 0; it < iterations; ++it) {
+        Writer w;
+        w.raw("{\"results\":[");
+        for (size_t i = 0; i < hits.size(); ++i) {
+            if (i > 0) w.raw(',');
+            w.raw("{\"id\":").string(hits[i].id).raw(",\"score\":").number(hits[i].score)
+             .raw(",\"answer\":").string(answer).raw('}');
+        }
+        w.raw("]}");
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double writer_us = std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+
+    // What handlers did before: an ostringstream and a per-character escape.
+    auto escape = [](std::ostream& os, const std::string& text) {
+        os << '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') os << '\\' << c;
+            else if (c == '\n') os << "\\n";
+            else os << c;
+        }
+        os << '"';
+    };
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t it = 0; it < iterations; ++it) {
+        std::ostringstream oss;
+        oss << "{\"results\":[";
+        for (size_t i = 0; i < hits.size(); ++i) {
+            if (i > 0) oss << ",";
+            oss << "{\"id\":";
+            escape(oss, hits[i].id);
+            oss << ",\"score\":" << hits[i].score << ",\"answer\":";
+            escape(oss, answer);
+            oss << "}";
+        }
+        oss << "]}";
+        std::string body = oss.str();
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double stream_us = std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+
+    std::cout << "  top-10, " << answer.size() << "-byte answers: Writer " << writer_us
+              << " us, ostringstream " << stream_us << " us (" << stream_us / writer_us << "x)" << std::endl;
+}
+
+void benchmark_parse() {
+    std::cout << "\nBenchmarking float array parsing..." << std::endl;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-0.2f, 0.2f);
+
+    for (size_t dim : {384, 768, 1536, 3072}) {
+        // Embedding APIs typically emit ~9 significant digits per component.
+        std::string json = "[";
+        char buf[32];
+        for (size_t i = 0; i < dim; ++i) {
+            if (i > 0) json += ",";
+            std::snprintf(buf, sizeof(buf), "%.9f", dist(rng));
+            json += buf;
+        }
+        json += "]";
+
+        const size_t iterations = 200000000 / json.size();
+        std::vector<float> out;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            out.clear();
+            parse_float_array(json, 0, out);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double fast_s = std::chrono::duration<double>(end - start).count();
+
+        // The previous parser: substring per number plus std::stof.
+        start = std::chrono::high_resolution_clock::now();
+        size_t baseline_iterations = iterations / 10 + 1;
+        for (size_t i = 0; i < baseline_iterations; ++i) {
+            out.clear();
+            size_t pos = 1;
+            while (pos < json.size() - 1) {
+                size_t comma = json.find_first_of(",]", pos);
+                out.push_back(std::stof(json.substr(pos, comma - pos)));
+                pos = comma + 1;
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        double stof_s = std::chrono::duration<double>(end - start).count();
+
+        double fast_gbps = json.size() * iterations / fast_s / 1e9;
+        double stof_gbps = json.size() * baseline_iterations / stof_s / 1e9;
+        std::cout << "  dim=" << dim << " (" << json.size() << " bytes): "
+                  << fast_gbps << " GB/s, stof " << stof_gbps << " GB/s ("
+                  << fast_gbps / stof_gbps << "x)" << std::endl;
+    }
+}
+
+int main() {
+    std::cout << "=== JSON Tests ===" << std::endl;
+
+    test_parse_matches_strtof();
+    test_parse_array();
+    test_format_round_trip();
+    test_document();
+    test_writer();
+
+    benchmark_parse();
+    benchmark_writer();
+
+    std::cout << "\n=== Tests Complete ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <cmath>
+#include "latency_histogram.hpp"
+
+using namespace vectordb;
+
+bool within(double actual, double expected, double tolerance) {
+    return std::abs(actual - expected) <= expected * tolerance;
+}
+
+void test_bucket_bounds() {
+    std::cout << "Testing bucket boundaries..." << std::endl;
+
+    // Every value must land in a bucket whose reported value is within the
+    // stated 1/32 (half a sub-bucket) of it.
+    bool ok = true;
+    for (uint64_t v = 0; v < (uint64_t(1) << 20) && ok; v = v < 64 ? v + 1 : v + v / 7) {
+        size_t bucket = LatencyHistogram::bucket_of(v);
+        uint64_t reported = LatencyHistogram::bucket_value(bucket);
+        if (bucket >= LatencyHistogram::BUCKETS || std::abs(double(reported) - double(v)) > v / 32.0 + 0.5) {
+            std::cout << "  FAIL: " << v << " us -> bucket " << bucket << " reports " << reported << std::endl;
+            ok = false;
+        }
+    }
+    size_t last = LatencyHistogram::bucket_of(UINT64_MAX);
+    if (last != LatencyHistogram::BUCKETS - 1) {
+        std::cout << "  FAIL: huge values land in bucket " << last << std::endl;
+        ok = false;
+    }
+    if (ok) {
+        std::cout << "  PASS: Values map to buckets within 1/32" << std::endl;
+    }
+}
+
+void test_percentiles() {
+    std::cout << "Testing percentiles against a sorted sample..." << std::endl;
+
+    std::mt19937 rng(42);
+    std::lognormal_distribution<double> dist(std::log(2000.0), 0.8);  // ~2 ms median, long tail
+    std::vector<uint64_t> samples(200000);
+    LatencyHistogram histogram;
+    for (auto& s : samples) {
+        s = static_cast<uint64_t>(dist(rng));
+        histogram.record_us(s);
+    }
+    std::sort(samples.begin(), samples.end());
+    auto exact = [&](double p) { return samples[static_cast<size_t>(p * samples.size() + 0.5) - 1] / 1000.0; };
+
+    auto summary = histogram.summary();
+    bool ok = summary.count == samples.size() &&
+              within(summary.p50_ms, exact(0.50), 0.035) &&
+              within(summary.p95_ms, exact(0.95), 0.035) &&
+              within(summary.p99_ms, exact(0.99), 0.035) &&
+              within(summary.p999_ms, exact(0.999), 0.035) &&
+              summary.max_ms == samples.back() / 1000.0;
+    if (ok) {
+        std::cout << "  PASS: p50=" << summary.p50_ms << " p99=" << summary.p99_ms
+                  << " p999=" << summary.p999_ms << " ms within 3.5%" << std::endl;
+    } else {
+        std::cout << "  FAIL: p50 " << summary.p50_ms << " vs " << exact(0.50)
+                  << ", p99 " << summary.p99_ms << " vs " << exact(0.99)
+                  << ", p999 " << summary.p999_ms << " vs " << exact(0.999) << std::endl;
+    }
+}
+
+void test_concurrent_recording() {
+    std::cout << "Testing recording from many threads..." << std::endl;
+
+    // More threads than shards, so some share one.
+    const size_t threads = LatencyHistogram::SHARDS + 8;
+    const uint64_t per_thread = 100000;
+    LatencyHistogram histogram;
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (uint64_t i = 0; i < per_thread; ++i) histogram.record_us(100 + t);
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    auto summary = histogram.summary();
+    double expected_mean = (100 + (100 + threads - 1)) / 2.0 / 1000.0;
+    if (summary.count == threads * per_thread && within(summary.mean_ms, expected_mean, 1e-9) &&
+        summary.max_ms == (100 + threads - 1) / 1000.0) {
+        std::cout << "  PASS: " << summary.count << " records merged from " << threads << " threads" << std::endl;
+    } else {
+        std::cout << "  FAIL: count=" << summary.count << " mean=" << summary.mean_ms
+                  << " max=" << summary.max_ms << std::endl;
+    }
+}
+
+void test_metrics_table() {
+    std::cout << "Testing per-collection metrics..." << std::endl;
+
+    LatencyMetrics metrics(2);
+    metrics.record("docs", "POST /search", std::chrono::milliseconds(3));
+    metrics.record("docs", "POST /search", std::chrono::milliseconds(5));
+    metrics.record("docs", "Search", std::chrono::milliseconds(1));
+    metrics.record("faq", "Search", std::chrono::milliseconds(2));
+    // Past the limit of two collections.
+    metrics.record("misspelt", "Search", std::chrono::milliseconds(2));
+    metrics.record("another", "Search", std::chrono::milliseconds(2));
+
+    auto docs = metrics.snapshot("docs");
+    auto all = metrics.snapshot();
+    auto other = metrics.snapshot(LatencyMetrics::OTHER_COLLECTION);
+    bool ok = docs.size() == 2 && docs[0].endpoint == "POST /search" && docs[0].latency.count == 2 &&
+              docs[0].latency.mean_ms == 4.0 && docs[1].endpoint == "Search" &&
+              all.size() == 4 && other.size() == 1 && other[0].latency.count == 2;
+    if (ok) {
+        std::cout << "  PASS: Endpoints kept apart per collection, overflow folded together" << std::endl;
+    } else {
+        std::cout << "  FAIL: docs=" << docs.size() << " all=" << all.size()
+                  << " other=" << other.size() << std::endl;
+    }
+}
+
+void benchmark_record(size_t threads) {
+    const uint64_t per_thread = 2000000;
+    LatencyHistogram histogram;
+    std::vector<std::thread> workers;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (uint64_t i = 0; i < per_thread; ++i) histogram.record_us((i * 2654435761u + t) % 50000);
+        });
+    }
+    for (auto& w : workers) w.join();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / (per_thread * threads);
+    std::cout << "  " << threads << " threads: " << ns << " ns per record (wall time / records)" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Latency Histogram Tests ===" << std::endl << std::endl;
+
+    test_bucket_bounds();
+    test_percentiles();
+    test_concurrent_recording();
+    test_metrics_table();
+
+    std::cout << "\nBenchmarking concurrent recording..." << std::endl;
+    for (size_t threads : {1, 4, 16}) {
+        benchmark_record(threads);
+    }
+
+    std::cout << "\n=== Tests Complete ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,231 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <regex>
+#include <stdexcept>
+#include "http_router.hpp"
+
+using namespace vectordb;
+
+struct RouteSpec {
+    const char* method;
+    const char* pattern;
+};
+
+// The vector service's endpoints, as registered by HTTPServer::build_routes().
+const std::vector<RouteSpec> ROUTES = {
+    {"GET", "/health"},
+    {"GET", "/admission"},
+    {"GET", "/shards"},
+    {"GET", "/latency"},
+    {"GET", "/latency/:name"},
+    {"GET", "/collections"},
+    {"POST", "/collections"},
+    {"GET", "/collections/:name"},
+    {"DELETE", "/collections/:name"},
+    {"POST", "/collections/:name/ingest"},
+    {"POST", "/search"},
+    {"POST", "/batch_search"},
+    {"POST", "/search_with_filter"},
+    {"POST", "/insert"},
+    {"POST", "/batch_insert"},
+    {"POST", "/save"},
+    {"POST", "/save_all"},
+    {"GET", "/stats/:name"},
+    {"GET", "/index/:name"},
+    {"GET", "/count/:name"},
+    {"GET", "/vectors/:collection/*id"},
+    {"PUT", "/vectors/:collection/*id"},
+    {"DELETE", "/vectors/:collection/*id"},
+    {"GET", "/tenants/:tenant/namespaces"},
+    {"POST", "/tenants/:tenant/namespaces"},
+    {"POST", "/tenants/:tenant/search"},
+    {"GET", "/tenants/:tenant/stats"},
+    {"POST", "/tenants/:tenant/:ns/faq"},
+    {"POST", "/tenants/:tenant/:ns/faq/bulk"},
+    {"GET", "/tenants/:tenant/:ns/faq/*id"},
+    {"PUT", "/tenants/:tenant/:ns/faq/*id"},
+    {"DELETE", "/tenants/:tenant/:ns/faq/*id"},
+    {"POST", "/tenants/:tenant/:ns/search"},
+    {"GET", "/tenants/:tenant/:ns/stats"},
+};
+
+// One concrete request per route, in the same order.
+const std::vector<std::pair<const char*, const char*>> REQUESTS = {
+    {"GET", "/health"},
+    {"GET", "/admission"},
+    {"GET", "/shards"},
+    {"GET", "/latency"},
+    {"GET", "/latency/faq_docs"},
+    {"GET", "/collections"},
+    {"POST", "/collections"},
+    {"GET", "/collections/faq_docs"},
+    {"DELETE", "/collections/faq_docs"},
+    {"POST", "/collections/faq_docs/ingest"},
+    {"POST", "/search"},
+    {"POST", "/batch_search"},
+    {"POST", "/search_with_filter"},
+    {"POST", "/insert"},
+    {"POST", "/batch_insert"},
+    {"POST", "/save"},
+    {"POST", "/save_all"},
+    {"GET", "/stats/faq_docs"},
+    {"GET", "/index/faq_docs"},
+    {"GET", "/count/faq_docs"},
+    {"GET", "/vectors/faq_docs/doc-42"},
+    {"PUT", "/vectors/faq_docs/doc-42"},
+    {"DELETE", "/vectors/faq_docs/doc-42"},
+    {"GET", "/tenants/acme/namespaces"},
+    {"POST", "/tenants/acme/namespaces"},
+    {"POST", "/tenants/acme/search"},
+    {"GET", "/tenants/acme/stats"},
+    {"POST", "/tenants/acme/support/faq"},
+    {"POST", "/tenants/acme/support/faq/bulk"},
+    {"GET", "/tenants/acme/support/faq/faq-7"},
+    {"PUT", "/tenants/acme/support/faq/faq-7"},
+    {"DELETE", "/tenants/acme/support/faq/faq-7"},
+    {"POST", "/tenants/acme/support/search"},
+    {"GET", "/tenants/acme/support/stats"},
+};
+
+HTTPRouter build_router() {
+    HTTPRouter router;
+    for (size_t i = 0; i < ROUTES.size(); ++i) {
+        router.add(ROUTES[i].method, ROUTES[i].pattern, static_cast<uint32_t>(i));
+    }
+    return router;
+}
+
+void test_every_route_matches() {
+    std::cout << "Testing route matching..." << std::endl;
+
+    HTTPRouter router = build_router();
+    size_t failures = 0;
+    for (size_t i = 0; i < REQUESTS.size(); ++i) {
+        RouteParams params;
+        uint32_t id = router.match(REQUESTS[i].first, REQUESTS[i].second, params);
+        if (id != i) {
+            std::cout << "  " << REQUESTS[i].first << " " << REQUESTS[i].second
+                      << " matched " << id << ", expected " << i << std::endl;
+            ++failures;
+        }
+    }
+
+    if (failures == 0) {
+        std::cout << "  PASS: " << REQUESTS.size() << " requests reached their routes" << std::endl;
+    } else {
+        std::cout << "  FAIL: " << failures << " misrouted" << std::endl;
+    }
+}
+
+void test_params_and_fallbacks() {
+    std::cout << "Testing parameters, backtracking and misses..." << std::endl;
+
+    HTTPRouter router = build_router();
+    bool ok = true;
+    auto expect = [&](const char* method, const char* path, const char* pattern,
+                      std::vector<std::string_view> expected) {
+        RouteParams params;
+        uint32_t id = router.match(method, path, params);
+        std::string got = id == HTTPRouter::NO_ROUTE ? "none" : ROUTES[id].pattern;
+        bool same = got == pattern && params.size() == expected.size();
+        for (size_t i = 0; same && i < expected.size(); ++i) {
+            same = params[i] == expected[i];
+        }
+        if (!same) {
+            std::cout << "  " << method << " " << path << " -> " << got << std::endl;
+            ok = false;
+        }
+    };
+
+    expect("GET", "/vectors/docs/a/b/c", "/vectors/:collection/*id", {"docs", "a/b/c"});
+    expect("GET", "/tenants/acme/support/faq/bulk", "/tenants/:tenant/:ns/faq/*id",
+           {"acme", "support", "bulk"});
+    expect("POST", "/tenants/acme/stats/search", "/tenants/:tenant/:ns/search", {"acme", "stats"});
+    expect("GET", "/tenants/acme/stats", "/tenants/:tenant/stats", {"acme"});
+    expect("GET", "/stats/docs?verbose=1", "/stats/:name", {"docs"});
+    expect("GET", "/collections/", "none", {});
+    expect("GET", "/vectors/docs", "none", {});
+    expect("GET", "/vectors/docs/", "none", {});
+    expect("PATCH", "/collections/docs", "none", {});
+    expect("POST", "/health", "none", {});
+    expect("GET", "/healthz", "none", {});
+    expect("GET", "/", "none", {});
+
+    bool rejected = false;
+    try {
+        HTTPRouter duplicate = build_router();
+        duplicate.add("GET", "/stats/:other", 99);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    if (!rejected) {
+        std::cout << "  duplicate route was accepted" << std::endl;
+        ok = false;
+    }
+
+    std::cout << (ok ? "  PASS" : "  FAIL") << std::endl;
+}
+
+void benchmark_lookup() {
+    std::cout << "\nBenchmarking route lookup over " << ROUTES.size() << " endpoints..." << std::endl;
+
+    HTTPRouter router = build_router();
+    const int iterations = 200000;
+
+    size_t checksum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int it = 0; it < iterations; ++it) {
+        for (const auto& [method, path] : REQUESTS) {
+            RouteParams params;
+            checksum += router.match(method, path, params) + params.size();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double trie_ns = std::chrono::duration<double, std::nano>(end - start).count() /
+                     (static_cast<double>(iterations) * REQUESTS.size());
+
+    // The regex-per-route approach this router replaced.
+    std::vector<std::pair<std::string, std::regex>> regexes;
+    for (const auto& route : ROUTES) {
+        std::string pattern = std::regex_replace(route.pattern, std::regex(":[a-z_]+"), "([^/]+)");
+        pattern = std::regex_replace(pattern, std::regex("\\*[a-z_]+"), "(.+)");
+        regexes.emplace_back(route.method, std::regex("^" + pattern + "$"));
+    }
+    const int regex_iterations = iterations / 100;
+    start = std::chrono::high_resolution_clock::now();
+    for (int it = 0; it < regex_iterations; ++it) {
+        for (const auto& [method, path] : REQUESTS) {
+            std::string target = path;
+            for (size_t i = 0; i < regexes.size(); ++i) {
+                std::smatch match;
+                if (regexes[i].first == method && std::regex_match(target, match, regexes[i].second)) {
+                    checksum += i + match.size();
+                    break;
+                }
+            }
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double regex_ns = std::chrono::duration<double, std::nano>(end - start).count() /
+                      (static_cast<double>(regex_iterations) * REQUESTS.size());
+
+    std::cout << "  trie:  " << trie_ns << " ns/lookup" << std::endl;
+    std::cout << "  regex: " << regex_ns << " ns/lookup (" << regex_ns / trie_ns << "x slower)"
+              << std::endl;
+    std::cout << "  (checksum " << checksum << ")" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Router Tests ===" << std::endl;
+
+    test_every_route_matches();
+    test_params_and_fallbacks();
+
+    benchmark_lookup();
+
+    std::cout << "\n=== Tests Complete ===" << std::endl;
+    return 0;
+}
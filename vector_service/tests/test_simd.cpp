@@ -73,6 +73,38 @@ void test_cosine_similarity() {
     }
 }
 
+void test_packed_conversions() {
+    std::cout << "Testing f16/int8 widening..." << std::endl;
+
+    // 1, -2, 0.5, 65504 (max half), smallest subnormal, -0, inf, 0.099975586,
+    // and a tail past the 8-wide block.
+    std::vector<uint16_t> half = {0x3C00, 0xC000, 0x3800, 0x7BFF, 0x0001, 0x8000, 0x7C00, 0x2E66, 0x3C00};
+    std::vector<float> expected = {1.0f, -2.0f, 0.5f, 65504.0f, 5.9604645e-8f, -0.0f,
+                                   INFINITY, 0.099975586f, 1.0f};
+    std::vector<float> out(half.size());
+    f16_to_f32(half.data(), out.data(), half.size());
+
+    bool ok = true;
+    for (size_t i = 0; i < half.size(); ++i) {
+        ok = ok && (out[i] == expected[i]) && (std::signbit(out[i]) == std::signbit(expected[i]));
+    }
+    if (ok) {
+        std::cout << "  PASS: f16_to_f32" << std::endl;
+    } else {
+        std::cout << "  FAIL: f16_to_f32 mismatch" << std::endl;
+    }
+
+    std::vector<int8_t> quantized = {127, -127, 0, 64};
+    std::vector<float> widened(quantized.size());
+    i8_to_f32(quantized.data(), 1.0f / 127.0f, widened.data(), quantized.size());
+    if (approx_equal(widened[0], 1.0f) && approx_equal(widened[1], -1.0f) &&
+        widened[2] == 0.0f && approx_equal(widened[3], 64.0f / 127.0f)) {
+        std::cout << "  PASS: i8_to_f32" << std::endl;
+    } else {
+        std::cout << "  FAIL: i8_to_f32 mismatch" << std::endl;
+    }
+}
+
 void benchmark_dot_product() {
     std::cout << "\nBenchmarking dot product (dim=1536, 100k iterations)..." << std::endl;
 
@@ -120,6 +152,7 @@ int main() {
     test_dot_product();
     test_euclidean_distance();
     test_cosine_similarity();
+    test_packed_conversions();
 
     benchmark_dot_product();
 